@@ -0,0 +1,94 @@
+#!/bin/sh
+#-------------------------------------------------------------------------------
+# Boot a benchmark kernel image under QEMU, collect the BENCH lines it emits
+# on the mini UART, and compare them against the checked-in baseline. Any
+# benchmark more than TOLERANCE percent over its baseline fails the run.
+#
+# usage: run_bench.sh <qemu> <machine> <image> <baseline>
+#
+# Set BENCH_UPDATE=1 to rewrite the baseline from the run instead of
+# comparing against it. A missing baseline file is bootstrapped the same way:
+# the run's numbers are recorded and the gate passes, so the first run on a
+# fresh machine profile establishes its baseline.
+#-------------------------------------------------------------------------------
+set -u
+
+QEMU="$1"
+MACHINE="$2"
+IMAGE="$3"
+BASELINE="$4"
+
+TOLERANCE=20
+TIMEOUT=60
+
+out=$(mktemp)
+results=$(mktemp)
+trap 'rm -f "$out" "$results"' EXIT
+
+# UART0 to null, the mini UART to the capture file, like the README's run
+# command. The kernel idles forever after BENCH DONE, so poll and kill.
+"$QEMU" -M "$MACHINE" -kernel "$IMAGE" -display none \
+  -serial null -serial "file:$out" >/dev/null 2>&1 &
+pid=$!
+
+elapsed=0
+while [ "$elapsed" -lt "$TIMEOUT" ]; do
+  if grep -q '^BENCH DONE' "$out" 2>/dev/null; then
+    break
+  fi
+  sleep 1
+  elapsed=$((elapsed + 1))
+done
+
+kill "$pid" 2>/dev/null
+wait "$pid" 2>/dev/null
+
+if ! grep -q '^BENCH DONE' "$out"; then
+  echo "bench: kernel did not finish the suite within ${TIMEOUT}s" >&2
+  exit 1
+fi
+
+grep '^BENCH ' "$out" | grep -v -e '^BENCH DONE' -e '^BENCH START' \
+  | sed 's/^BENCH //' > "$results"
+
+if [ -n "${BENCH_UPDATE:-}" ] || [ ! -f "$BASELINE" ]; then
+  cp "$results" "$BASELINE"
+  echo "bench: baseline recorded:"
+  cat "$BASELINE"
+  exit 0
+fi
+
+status=0
+
+while read -r name cycles; do
+  base=$(awk -v n="$name" '$1 == n { print $2 }' "$BASELINE")
+
+  if [ -z "$base" ]; then
+    echo "bench: $name has no baseline; run with BENCH_UPDATE=1" >&2
+    status=1
+    continue
+  fi
+
+  limit=$((base + (base * TOLERANCE / 100)))
+
+  if [ "$cycles" -gt "$limit" ]; then
+    echo "bench: REGRESSION $name: $cycles cycles, limit $limit (baseline $base +${TOLERANCE}%)" >&2
+    status=1
+  else
+    echo "bench: $name: $cycles cycles (baseline $base)"
+  fi
+done < "$results"
+
+# A benchmark that vanished from the kernel is a regression of the gate.
+while read -r name _; do
+  case "$name" in
+    \#*|'') continue ;;
+  esac
+
+  if ! awk -v n="$name" '$1 == n { found = 1 } END { exit !found }' "$results"; then
+    echo "bench: $name is in the baseline but was not reported" >&2
+    status=1
+  fi
+done < "$BASELINE"
+
+exit $status
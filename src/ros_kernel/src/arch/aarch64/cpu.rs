@@ -0,0 +1,193 @@
+use core::arch::asm;
+
+extern "C" {
+  fn smp_release_secondaries();
+}
+
+/// @fn core_id() -> usize
+/// @brief   Get the ID of the executing core.
+/// @details Boot caches the MPIDR_EL1 affinity bits in TPIDR_EL1, so the
+///          read is a single instruction on the per-core data paths.
+/// @returns The core ID.
+pub fn core_id() -> usize {
+  let id: u64;
+
+  unsafe {
+    asm!("mrs {}, tpidr_el1", out(reg) id);
+  }
+
+  id as usize
+}
+
+/// @fn release_secondaries()
+/// @brief   Release the secondary cores parked by the boot code.
+/// @details Must only be called once by the primary core after the kernel is
+///          far enough along for the secondary stubs to run.
+pub fn release_secondaries() {
+  unsafe {
+    smp_release_secondaries();
+  }
+}
+/// @fn enable_interrupts()
+/// @brief Unmask IRQs on the executing core.
+pub fn enable_interrupts() {
+  unsafe {
+    asm!("msr daifclr, #2");
+  }
+}
+
+/// @fn disable_interrupts()
+/// @brief Mask IRQs on the executing core.
+pub fn disable_interrupts() {
+  unsafe {
+    asm!("msr daifset, #2");
+  }
+}
+
+/// @fn save_and_disable_interrupts() -> usize
+/// @brief   Mask IRQs on the executing core, returning the prior mask state.
+/// @details Unlike disable_interrupts, safe in contexts that may already run
+///          with IRQs masked, such as IRQ handlers.
+/// @returns The DAIF value to hand to restore_interrupts.
+pub fn save_and_disable_interrupts() -> usize {
+  let daif: u64;
+
+  unsafe {
+    asm!(
+      "mrs {}, daif",
+      "msr daifset, #2",
+      out(reg) daif
+    );
+  }
+
+  daif as usize
+}
+
+/// @fn restore_interrupts(state: usize)
+/// @brief   Restore the IRQ mask state saved by save_and_disable_interrupts.
+/// @param[in] state The saved DAIF value.
+pub fn restore_interrupts(state: usize) {
+  // DAIF.I is bit 7; only unmask if IRQs were unmasked before.
+  if (state & (0x1 << 7)) == 0 {
+    enable_interrupts();
+  }
+}
+
+/// @var CACHE_LINE_SIZE
+/// @brief Data cache line size of the Cortex-A53/A72.
+const CACHE_LINE_SIZE: usize = 64;
+
+/// @fn clean_dcache_range(base: usize, size: usize)
+/// @brief   Clean a range of the data cache to the point of coherency.
+/// @details Writes dirty lines back to RAM so non-coherent observers such as
+///          the DMA engine see them.
+/// @param[in] base The base of the range.
+/// @param[in] size The size of the range in bytes.
+pub fn clean_dcache_range(base: usize, size: usize) {
+  let mut line = base & !(CACHE_LINE_SIZE - 1);
+
+  while line < base + size {
+    unsafe {
+      asm!("dc cvac, {}", in(reg) line);
+    }
+
+    line += CACHE_LINE_SIZE;
+  }
+
+  unsafe {
+    asm!("dsb sy");
+  }
+}
+
+/// @fn invalidate_dcache_range(base: usize, size: usize)
+/// @brief   Invalidate a range of the data cache without cleaning it.
+/// @details Drops the range from the cache so later reads fetch what a
+///          non-coherent observer wrote to RAM; any dirty lines are lost.
+///          For buffers handed wholesale to the DMA engine.
+/// @param[in] base The base of the range.
+/// @param[in] size The size of the range in bytes.
+pub fn invalidate_dcache_range(base: usize, size: usize) {
+  let mut line = base & !(CACHE_LINE_SIZE - 1);
+
+  while line < base + size {
+    unsafe {
+      asm!("dc ivac, {}", in(reg) line);
+    }
+
+    line += CACHE_LINE_SIZE;
+  }
+
+  unsafe {
+    asm!("dsb sy");
+  }
+}
+
+/// @fn flush_dcache_range(base: usize, size: usize)
+/// @brief   Clean and invalidate a range of the data cache.
+/// @details Writes dirty lines back and drops the range from the cache, so
+///          later reads fetch what a non-coherent observer wrote to RAM.
+/// @param[in] base The base of the range.
+/// @param[in] size The size of the range in bytes.
+pub fn flush_dcache_range(base: usize, size: usize) {
+  let mut line = base & !(CACHE_LINE_SIZE - 1);
+
+  while line < base + size {
+    unsafe {
+      asm!("dc civac, {}", in(reg) line);
+    }
+
+    line += CACHE_LINE_SIZE;
+  }
+
+  unsafe {
+    asm!("dsb sy");
+  }
+}
+
+/// @var BLOCK_SIZE
+/// @brief The boot identity map uses 2 MiB level 2 blocks.
+const BLOCK_SIZE: usize = 0x200000;
+
+/// @var PT_BLOCK_WC
+/// @brief   Level 2 descriptor flags for a write-combining block.
+/// @details Pairs with the descriptor and MAIR definitions in boot.S: block
+///          entry, MAIR index 2 (Normal non-cacheable), access flag, and
+///          execute-never at both ELs.
+const PT_BLOCK_WC: u64 = 0x1 | (2 << 2) | (1 << 10) | (1 << 53) | (1 << 54);
+
+extern "C" {
+  static mut pt_level2: [u64; 4 * 512];
+}
+
+/// @fn remap_write_combine(base: usize, size: usize)
+/// @brief   Retag a physical range as write-combining in the identity map.
+/// @details Flushes the range out of the data cache first so no dirty lines
+///          write back over it later, rewrites the covering level 2 blocks
+///          with the Normal non-cacheable attribute, and invalidates the TLB.
+///          Block alignment is requested from the VideoCore, not guaranteed;
+///          an unaligned range is left on its existing mapping rather than
+///          retagging memory outside it.
+/// @param[in] base The base of the range.
+/// @param[in] size The size of the range in bytes.
+pub fn remap_write_combine(base: usize, size: usize) {
+  if base % BLOCK_SIZE != 0 {
+    crate::dbg_print!(
+      "Leaving unaligned range at {:#x} on its existing mapping.\n",
+      base
+    );
+    return;
+  }
+
+  flush_dcache_range(base, size);
+
+  let first = base / BLOCK_SIZE;
+  let last = (base + size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+  unsafe {
+    for block in first..last {
+      pt_level2[block] = ((block * BLOCK_SIZE) as u64) | PT_BLOCK_WC;
+    }
+
+    asm!("dsb ish", "tlbi vmalle1", "dsb ish", "isb");
+  }
+}
@@ -0,0 +1,51 @@
+use core::arch::asm;
+
+/// @var PMCR_E
+/// @brief PMCR_EL0 bit enabling the event counters.
+const PMCR_E: u64 = 0x1 << 0;
+
+/// @var PMCR_C
+/// @brief PMCR_EL0 bit resetting the cycle counter.
+const PMCR_C: u64 = 0x1 << 2;
+
+/// @var PMCNTEN_CYCLE
+/// @brief PMCNTENSET_EL0 bit enabling the cycle counter.
+const PMCNTEN_CYCLE: u64 = 0x1 << 31;
+
+/// @fn init_cycle_counter()
+/// @brief   Enable the PMU cycle counter on the executing core.
+/// @details Clears the cycle counter filter so cycles count at every
+///          exception level, then resets and enables PMCCNTR_EL0.
+pub fn init_cycle_counter() {
+  unsafe {
+    asm!(
+      "msr pmccfiltr_el0, xzr",
+      "mrs {tmp}, pmcr_el0",
+      "orr {tmp}, {tmp}, {bits}",
+      "msr pmcr_el0, {tmp}",
+      "msr pmcntenset_el0, {cycle}",
+      tmp = out(reg) _,
+      bits = in(reg) PMCR_E | PMCR_C,
+      cycle = in(reg) PMCNTEN_CYCLE,
+    );
+  }
+}
+
+/// @fn read_cycles() -> u64
+/// @brief   Read the PMU cycle counter.
+/// @details The ISB keeps the read from drifting across the instructions
+///          being measured.
+/// @returns The cycle count since init_cycle_counter.
+pub fn read_cycles() -> u64 {
+  let cycles: u64;
+
+  unsafe {
+    asm!(
+      "isb",
+      "mrs {}, pmccntr_el0",
+      out(reg) cycles
+    );
+  }
+
+  cycles
+}
@@ -1 +1,134 @@
-pub struct _ROSTask {}
+use core::arch::asm;
+
+extern "C" {
+  fn _task_start();
+  fn switch_context(prev: *mut CPUContext, next: *const CPUContext);
+  fn fp_save_context(ctx: *mut FpContext);
+  fn fp_restore_context(ctx: *const FpContext);
+}
+
+/// @var CPACR_FPEN_TRAP
+/// @brief CPACR_EL1 value trapping FP/SIMD accesses at EL0 and EL1.
+const CPACR_FPEN_TRAP: u64 = 0;
+
+/// @var CPACR_FPEN_NO_TRAP
+/// @brief CPACR_EL1 value granting full FP/SIMD access.
+const CPACR_FPEN_NO_TRAP: u64 = 3 << 20;
+
+/// @struct CPUContext
+/// @brief   A task's saved CPU context.
+/// @details The layout pairs with switch_context in task.S: the callee-saved
+///          registers, the frame pointer, the stack pointer, and the link
+///          register. Everything else is dead across the switch or saved in
+///          the exception frame on the task's stack.
+#[repr(C)]
+pub struct CPUContext {
+  regs: [u64; 10],
+  fp: u64,
+  sp: u64,
+  lr: u64,
+}
+
+impl CPUContext {
+  pub const fn new() -> Self {
+    CPUContext {
+      regs: [0; 10],
+      fp: 0,
+      sp: 0,
+      lr: 0,
+    }
+  }
+}
+
+/// @fn init_context(ctx: &mut CPUContext, entry: usize, arg: usize, stack_top: usize)
+/// @brief   Prepare a context for a task's first run.
+/// @details switch_context returns into _task_start, which unmasks IRQs and
+///          calls the entry point with the argument.
+/// @param[in] ctx       The context to prepare.
+/// @param[in] entry     The task entry point.
+/// @param[in] arg       The argument passed to the entry point.
+/// @param[in] stack_top The top of the task's kernel stack.
+pub fn init_context(ctx: &mut CPUContext, entry: usize, arg: usize, stack_top: usize) {
+  ctx.regs[0] = entry as u64;
+  ctx.regs[1] = arg as u64;
+  ctx.sp = stack_top as u64;
+  ctx.lr = _task_start as usize as u64;
+}
+
+/// @fn context_switch(prev: &mut CPUContext, next: &CPUContext)
+/// @brief   Switch from the executing task's context to another's.
+/// @details Returns when something switches back to the previous context.
+/// @param[in] prev The executing task's context to save into.
+/// @param[in] next The context to switch to.
+pub fn context_switch(prev: &mut CPUContext, next: &CPUContext) {
+  unsafe {
+    switch_context(prev, next);
+  }
+}
+
+/// @struct FpContext
+/// @brief   A task's saved FP/SIMD state.
+/// @details The layout pairs with fp_save_context in task.S: the 32 Q
+///          registers followed by FPCR and FPSR. Aligned for the paired
+///          Q-register stores.
+#[repr(C, align(16))]
+pub struct FpContext {
+  q: [u64; 64],
+  fpcr: u64,
+  fpsr: u64,
+}
+
+impl FpContext {
+  pub const fn new() -> Self {
+    FpContext {
+      q: [0; 64],
+      fpcr: 0,
+      fpsr: 0,
+    }
+  }
+}
+
+/// @fn fp_save(ctx: &mut FpContext)
+/// @brief   Save the executing FP/SIMD state into a context.
+/// @details The FP trap must be disabled first.
+/// @param[in] ctx The context to save into.
+pub fn fp_save(ctx: &mut FpContext) {
+  unsafe {
+    fp_save_context(ctx);
+  }
+}
+
+/// @fn fp_restore(ctx: &FpContext)
+/// @brief   Load the FP/SIMD state from a context.
+/// @details The FP trap must be disabled first.
+/// @param[in] ctx The context to load.
+pub fn fp_restore(ctx: &FpContext) {
+  unsafe {
+    fp_restore_context(ctx);
+  }
+}
+
+/// @fn fp_trap_enable()
+/// @brief Trap the next FP/SIMD access so the scheduler can migrate the
+///        vector state lazily.
+pub fn fp_trap_enable() {
+  unsafe {
+    asm!(
+      "msr cpacr_el1, {val}",
+      "isb",
+      val = in(reg) CPACR_FPEN_TRAP,
+    );
+  }
+}
+
+/// @fn fp_trap_disable()
+/// @brief Grant the executing task full FP/SIMD access.
+pub fn fp_trap_disable() {
+  unsafe {
+    asm!(
+      "msr cpacr_el1, {val}",
+      "isb",
+      val = in(reg) CPACR_FPEN_NO_TRAP,
+    );
+  }
+}
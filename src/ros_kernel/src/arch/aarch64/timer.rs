@@ -0,0 +1,53 @@
+use core::arch::asm;
+
+/// @fn counter_freq() -> u64
+/// @brief   Get the generic timer counter frequency.
+/// @returns The frequency in Hz read from CNTFRQ_EL0; the firmware programs
+///          it before handing off to the kernel.
+pub fn counter_freq() -> u64 {
+  let freq: u64;
+
+  unsafe {
+    asm!("mrs {}, cntfrq_el0", out(reg) freq);
+  }
+
+  freq
+}
+
+/// @fn counter() -> u64
+/// @brief   Read the generic timer physical counter.
+/// @details The ISB keeps the read from being hoisted above prior
+///          instructions; CNTPCT_EL0 is allowed to be read speculatively.
+/// @returns The counter value.
+pub fn counter() -> u64 {
+  let count: u64;
+
+  unsafe {
+    asm!("isb", "mrs {}, cntpct_el0", out(reg) count);
+  }
+
+  count
+}
+
+/// @fn set_timer(ticks: u64)
+/// @brief   Program the EL1 physical timer to fire in the given number of
+///          counter ticks.
+/// @param[in] ticks The number of ticks until the timer condition is met.
+pub fn set_timer(ticks: u64) {
+  unsafe {
+    asm!(
+      "msr cntp_tval_el0, {ticks}",
+      "msr cntp_ctl_el0, {ctl}",
+      ticks = in(reg) ticks,
+      ctl = in(reg) 0x1u64,
+    );
+  }
+}
+
+/// @fn stop_timer()
+/// @brief Disable the EL1 physical timer.
+pub fn stop_timer() {
+  unsafe {
+    asm!("msr cntp_ctl_el0, {}", in(reg) 0x0u64);
+  }
+}
@@ -0,0 +1,141 @@
+use core::arch::asm;
+
+/// @fn core_id() -> usize
+/// @brief   Get the ID of the executing core.
+/// @details Boot caches the MPIDR affinity bits in TPIDRPRW, so the read is
+///          a single instruction on the per-core data paths.
+/// @returns The core ID.
+pub fn core_id() -> usize {
+  let id: u32;
+
+  unsafe {
+    asm!("mrc p15, 0, {}, c13, c0, 4", out(reg) id);
+  }
+
+  id as usize
+}
+
+/// @fn release_secondaries()
+/// @brief   Release the secondary cores parked by the boot code.
+/// @details The ARMv7 boot path does not bring up secondary cores yet, so this
+///          is a no-op.
+pub fn release_secondaries() {}
+/// @fn enable_interrupts()
+/// @brief Unmask IRQs on the executing core.
+pub fn enable_interrupts() {
+  unsafe {
+    asm!("cpsie i");
+  }
+}
+
+/// @fn disable_interrupts()
+/// @brief Mask IRQs on the executing core.
+pub fn disable_interrupts() {
+  unsafe {
+    asm!("cpsid i");
+  }
+}
+
+/// @fn save_and_disable_interrupts() -> usize
+/// @brief   Mask IRQs on the executing core, returning the prior mask state.
+/// @details Unlike disable_interrupts, safe in contexts that may already run
+///          with IRQs masked, such as IRQ handlers.
+/// @returns The CPSR value to hand to restore_interrupts.
+pub fn save_and_disable_interrupts() -> usize {
+  let cpsr: u32;
+
+  unsafe {
+    asm!(
+      "mrs {}, cpsr",
+      "cpsid i",
+      out(reg) cpsr
+    );
+  }
+
+  cpsr as usize
+}
+
+/// @fn restore_interrupts(state: usize)
+/// @brief   Restore the IRQ mask state saved by save_and_disable_interrupts.
+/// @param[in] state The saved CPSR value.
+pub fn restore_interrupts(state: usize) {
+  // CPSR.I is bit 7; only unmask if IRQs were unmasked before.
+  if (state & (0x1 << 7)) == 0 {
+    enable_interrupts();
+  }
+}
+
+/// @var CACHE_LINE_SIZE
+/// @brief Data cache line size of the Cortex-A7.
+const CACHE_LINE_SIZE: usize = 64;
+
+/// @fn clean_dcache_range(base: usize, size: usize)
+/// @brief   Clean a range of the data cache to the point of coherency.
+/// @details Writes dirty lines back to RAM so non-coherent observers such as
+///          the DMA engine see them.
+/// @param[in] base The base of the range.
+/// @param[in] size The size of the range in bytes.
+pub fn clean_dcache_range(base: usize, size: usize) {
+  let mut line = base & !(CACHE_LINE_SIZE - 1);
+
+  while line < base + size {
+    unsafe {
+      asm!("mcr p15, 0, {}, c7, c10, 1", in(reg) line);
+    }
+
+    line += CACHE_LINE_SIZE;
+  }
+
+  unsafe {
+    asm!("dsb");
+  }
+}
+
+/// @fn invalidate_dcache_range(base: usize, size: usize)
+/// @brief   Invalidate a range of the data cache without cleaning it.
+/// @details Drops the range from the cache so later reads fetch what a
+///          non-coherent observer wrote to RAM; any dirty lines are lost.
+/// @param[in] base The base of the range.
+/// @param[in] size The size of the range in bytes.
+pub fn invalidate_dcache_range(base: usize, size: usize) {
+  let mut line = base & !(CACHE_LINE_SIZE - 1);
+
+  while line < base + size {
+    unsafe {
+      asm!("mcr p15, 0, {}, c7, c6, 1", in(reg) line);
+    }
+
+    line += CACHE_LINE_SIZE;
+  }
+
+  unsafe {
+    asm!("dsb");
+  }
+}
+
+/// @fn flush_dcache_range(base: usize, size: usize)
+/// @brief   Clean and invalidate a range of the data cache.
+/// @details Writes dirty lines back and drops the range from the cache, so
+///          later reads fetch what a non-coherent observer wrote to RAM.
+/// @param[in] base The base of the range.
+/// @param[in] size The size of the range in bytes.
+pub fn flush_dcache_range(base: usize, size: usize) {
+  let mut line = base & !(CACHE_LINE_SIZE - 1);
+
+  while line < base + size {
+    unsafe {
+      asm!("mcr p15, 0, {}, c7, c14, 1", in(reg) line);
+    }
+
+    line += CACHE_LINE_SIZE;
+  }
+
+  unsafe {
+    asm!("dsb");
+  }
+}
+
+/// @fn remap_write_combine(base: usize, size: usize)
+/// @brief   No-op; the ARMv7 port runs with the MMU disabled, so every
+///          mapping is already non-cacheable.
+pub fn remap_write_combine(_base: usize, _size: usize) {}
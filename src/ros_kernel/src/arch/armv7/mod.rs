@@ -1 +1,4 @@
+pub mod cpu;
+pub mod profile;
 pub mod task;
+pub mod timer;
@@ -0,0 +1,48 @@
+use core::arch::asm;
+
+/// @var PMCR_E
+/// @brief PMCR bit enabling the event counters.
+const PMCR_E: u32 = 0x1 << 0;
+
+/// @var PMCR_C
+/// @brief PMCR bit resetting the cycle counter.
+const PMCR_C: u32 = 0x1 << 2;
+
+/// @var PMCNTEN_CYCLE
+/// @brief PMCNTENSET bit enabling the cycle counter.
+const PMCNTEN_CYCLE: u32 = 0x1 << 31;
+
+/// @fn init_cycle_counter()
+/// @brief Reset and enable the PMU cycle counter on the executing core.
+pub fn init_cycle_counter() {
+  unsafe {
+    asm!(
+      "mrc p15, 0, {tmp}, c9, c12, 0",
+      "orr {tmp}, {tmp}, {bits}",
+      "mcr p15, 0, {tmp}, c9, c12, 0",
+      "mcr p15, 0, {cycle}, c9, c12, 1",
+      tmp = out(reg) _,
+      bits = in(reg) PMCR_E | PMCR_C,
+      cycle = in(reg) PMCNTEN_CYCLE,
+    );
+  }
+}
+
+/// @fn read_cycles() -> u64
+/// @brief   Read the PMU cycle counter.
+/// @details CCNT is 32 bits on ARMv7, so it wraps after a few seconds at
+///          speed; measurements only see the wrap if a scope spans it.
+/// @returns The cycle count since init_cycle_counter.
+pub fn read_cycles() -> u64 {
+  let cycles: u32;
+
+  unsafe {
+    asm!(
+      "isb",
+      "mrc p15, 0, {}, c9, c13, 0",
+      out(reg) cycles
+    );
+  }
+
+  cycles as u64
+}
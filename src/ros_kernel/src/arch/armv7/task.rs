@@ -1 +1,78 @@
-pub struct _ROSTask {}
+extern "C" {
+  fn _task_start();
+  fn switch_context(prev: *mut CPUContext, next: *const CPUContext);
+}
+
+/// @struct CPUContext
+/// @brief   A task's saved CPU context.
+/// @details The layout pairs with switch_context in task.S: the callee-saved
+///          registers, the stack pointer, and the link register. Everything
+///          else is dead across the switch or saved on the task's stack.
+#[repr(C)]
+pub struct CPUContext {
+  regs: [u32; 8],
+  sp: u32,
+  lr: u32,
+}
+
+impl CPUContext {
+  pub const fn new() -> Self {
+    CPUContext {
+      regs: [0; 8],
+      sp: 0,
+      lr: 0,
+    }
+  }
+}
+
+/// @fn init_context(ctx: &mut CPUContext, entry: usize, arg: usize, stack_top: usize)
+/// @brief   Prepare a context for a task's first run.
+/// @details switch_context returns into _task_start, which unmasks IRQs and
+///          calls the entry point with the argument.
+/// @param[in] ctx       The context to prepare.
+/// @param[in] entry     The task entry point.
+/// @param[in] arg       The argument passed to the entry point.
+/// @param[in] stack_top The top of the task's kernel stack.
+pub fn init_context(ctx: &mut CPUContext, entry: usize, arg: usize, stack_top: usize) {
+  ctx.regs[0] = entry as u32;
+  ctx.regs[1] = arg as u32;
+  ctx.sp = stack_top as u32;
+  ctx.lr = _task_start as usize as u32;
+}
+
+/// @fn context_switch(prev: &mut CPUContext, next: &CPUContext)
+/// @brief   Switch from the executing task's context to another's.
+/// @details Returns when something switches back to the previous context.
+/// @param[in] prev The executing task's context to save into.
+/// @param[in] next The context to switch to.
+pub fn context_switch(prev: &mut CPUContext, next: &CPUContext) {
+  unsafe {
+    switch_context(prev, next);
+  }
+}
+
+/// @struct FpContext
+/// @brief Empty FP/SIMD context; VFP/NEON is not enabled on ARMv7 yet.
+pub struct FpContext {}
+
+impl FpContext {
+  pub const fn new() -> Self {
+    FpContext {}
+  }
+}
+
+/// @fn fp_save(ctx: &mut FpContext)
+/// @brief No-op; VFP/NEON is not enabled on ARMv7 yet.
+pub fn fp_save(_ctx: &mut FpContext) {}
+
+/// @fn fp_restore(ctx: &FpContext)
+/// @brief No-op; VFP/NEON is not enabled on ARMv7 yet.
+pub fn fp_restore(_ctx: &FpContext) {}
+
+/// @fn fp_trap_enable()
+/// @brief No-op; VFP/NEON is not enabled on ARMv7 yet.
+pub fn fp_trap_enable() {}
+
+/// @fn fp_trap_disable()
+/// @brief No-op; VFP/NEON is not enabled on ARMv7 yet.
+pub fn fp_trap_disable() {}
@@ -0,0 +1,55 @@
+use core::arch::asm;
+
+/// @fn counter_freq() -> u64
+/// @brief   Get the generic timer counter frequency.
+/// @returns The frequency in Hz read from CNTFRQ; the firmware programs it
+///          before handing off to the kernel.
+pub fn counter_freq() -> u64 {
+  let freq: u32;
+
+  unsafe {
+    asm!("mrc p15, 0, {}, c14, c0, 0", out(reg) freq);
+  }
+
+  freq as u64
+}
+
+/// @fn counter() -> u64
+/// @brief   Read the generic timer physical counter.
+/// @details The ISB keeps the read from being hoisted above prior
+///          instructions; CNTPCT is allowed to be read speculatively.
+/// @returns The counter value.
+pub fn counter() -> u64 {
+  let lo: u32;
+  let hi: u32;
+
+  unsafe {
+    asm!("isb", "mrrc p15, 0, {}, {}, c14", out(reg) lo, out(reg) hi);
+  }
+
+  ((hi as u64) << 32) | (lo as u64)
+}
+
+/// @fn set_timer(ticks: u64)
+/// @brief   Program the PL1 physical timer to fire in the given number of
+///          counter ticks.
+/// @param[in] ticks The number of ticks until the timer condition is met;
+///                  CNTP_TVAL only holds 32 bits.
+pub fn set_timer(ticks: u64) {
+  unsafe {
+    asm!(
+      "mcr p15, 0, {ticks}, c14, c2, 0",
+      "mcr p15, 0, {ctl}, c14, c2, 1",
+      ticks = in(reg) ticks as u32,
+      ctl = in(reg) 0x1u32,
+    );
+  }
+}
+
+/// @fn stop_timer()
+/// @brief Disable the PL1 physical timer.
+pub fn stop_timer() {
+  unsafe {
+    asm!("mcr p15, 0, {}, c14, c2, 1", in(reg) 0x0u32);
+  }
+}
@@ -0,0 +1,44 @@
+/// @fn core_id() -> usize
+/// @brief   Get the ID of the executing core.
+/// @returns Always 0 on the host.
+pub fn core_id() -> usize {
+  0
+}
+
+/// @fn release_secondaries()
+/// @brief No-op on the host.
+pub fn release_secondaries() {}
+/// @fn enable_interrupts()
+/// @brief No-op on the host.
+pub fn enable_interrupts() {}
+
+/// @fn disable_interrupts()
+/// @brief No-op on the host.
+pub fn disable_interrupts() {}
+
+/// @fn save_and_disable_interrupts() -> usize
+/// @brief   Stub mask save.
+/// @returns Always 0 on the host.
+pub fn save_and_disable_interrupts() -> usize {
+  0
+}
+
+/// @fn restore_interrupts(state: usize)
+/// @brief No-op on the host.
+pub fn restore_interrupts(_state: usize) {}
+
+/// @fn clean_dcache_range(base: usize, size: usize)
+/// @brief No-op on the host.
+pub fn clean_dcache_range(_base: usize, _size: usize) {}
+
+/// @fn invalidate_dcache_range(base: usize, size: usize)
+/// @brief No-op on the host.
+pub fn invalidate_dcache_range(_base: usize, _size: usize) {}
+
+/// @fn flush_dcache_range(base: usize, size: usize)
+/// @brief No-op on the host.
+pub fn flush_dcache_range(_base: usize, _size: usize) {}
+
+/// @fn remap_write_combine(base: usize, size: usize)
+/// @brief No-op on the host.
+pub fn remap_write_combine(_base: usize, _size: usize) {}
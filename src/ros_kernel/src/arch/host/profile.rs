@@ -0,0 +1,10 @@
+/// @fn init_cycle_counter()
+/// @brief No-op on the host.
+pub fn init_cycle_counter() {}
+
+/// @fn read_cycles() -> u64
+/// @brief   Stub cycle counter read.
+/// @returns Always 0 on the host.
+pub fn read_cycles() -> u64 {
+  0
+}
@@ -0,0 +1,43 @@
+/// @struct CPUContext
+/// @brief Empty CPU context on the host.
+pub struct CPUContext {}
+
+impl CPUContext {
+  pub const fn new() -> Self {
+    CPUContext {}
+  }
+}
+
+/// @fn init_context(ctx: &mut CPUContext, entry: usize, arg: usize, stack_top: usize)
+/// @brief No-op on the host.
+pub fn init_context(_ctx: &mut CPUContext, _entry: usize, _arg: usize, _stack_top: usize) {}
+
+/// @fn context_switch(prev: &mut CPUContext, next: &CPUContext)
+/// @brief No-op on the host.
+pub fn context_switch(_prev: &mut CPUContext, _next: &CPUContext) {}
+
+/// @struct FpContext
+/// @brief Empty FP/SIMD context; the host has no FP trap.
+pub struct FpContext {}
+
+impl FpContext {
+  pub const fn new() -> Self {
+    FpContext {}
+  }
+}
+
+/// @fn fp_save(ctx: &mut FpContext)
+/// @brief No-op; the host has no FP trap.
+pub fn fp_save(_ctx: &mut FpContext) {}
+
+/// @fn fp_restore(ctx: &FpContext)
+/// @brief No-op; the host has no FP trap.
+pub fn fp_restore(_ctx: &FpContext) {}
+
+/// @fn fp_trap_enable()
+/// @brief No-op; the host has no FP trap.
+pub fn fp_trap_enable() {}
+
+/// @fn fp_trap_disable()
+/// @brief No-op; the host has no FP trap.
+pub fn fp_trap_disable() {}
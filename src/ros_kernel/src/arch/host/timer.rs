@@ -0,0 +1,19 @@
+/// @fn counter_freq() -> u64
+/// @returns A nominal 1 MHz frequency on the host.
+pub fn counter_freq() -> u64 {
+  1000000
+}
+
+/// @fn counter() -> u64
+/// @returns Always 0 on the host.
+pub fn counter() -> u64 {
+  0
+}
+
+/// @fn set_timer(ticks: u64)
+/// @brief No-op on the host.
+pub fn set_timer(_ticks: u64) {}
+
+/// @fn stop_timer()
+/// @brief No-op on the host.
+pub fn stop_timer() {}
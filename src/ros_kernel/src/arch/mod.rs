@@ -2,8 +2,14 @@
 pub mod aarch64;
 #[cfg(target_arch = "arm")]
 pub mod armv7;
+// The host stubs keep cargo check and rust-analyzer usable on development
+// machines. They are never part of a kernel image.
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+pub mod host;
 
 #[cfg(target_arch = "aarch64")]
 pub use aarch64::*;
 #[cfg(target_arch = "arm")]
 pub use armv7::*;
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+pub use host::*;
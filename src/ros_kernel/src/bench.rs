@@ -0,0 +1,75 @@
+//! In-kernel benchmark suite.
+//!
+//! Compiled in by the `bench` cargo feature for the CMake bench target. The
+//! suite runs once after initialization, emits one `BENCH <name> <cycles>`
+//! line per benchmark on the mini UART, and finishes with `BENCH DONE`; the
+//! bench script parses the lines and compares them to the checked-in
+//! baseline.
+
+use crate::dbg_print;
+use crate::debug::profile;
+use crate::drivers::video::console;
+use crate::kprint;
+use crate::peripherals::mailbox;
+use crate::support::print;
+use core::fmt::Write;
+
+/// @var ITERATIONS
+/// @brief Timed iterations per benchmark; each benchmark also runs once
+///        untimed to warm the caches.
+const ITERATIONS: u64 = 16;
+
+/// @fn run()
+/// @brief Run the benchmark suite and report per-iteration cycle counts.
+pub fn run() {
+  dbg_print!("BENCH START\n");
+
+  bench("fb_clear", console::clear);
+
+  // Walk the cursor to the bottom of the console so every benchmarked
+  // newline scrolls.
+  for _ in 0..135 {
+    kprint!("\n");
+  }
+
+  bench("scroll", || kprint!("\n"));
+
+  bench("glyph", || {
+    kprint!("ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789\n")
+  });
+
+  bench("mailbox_rtt", || {
+    *mailbox::get_buffer_mut() = mailbox::MessageBuilder::new()
+      .tag(mailbox::MBOX_TAG_GETPITCH, &[0])
+      .build();
+    mailbox::send(mailbox::MBOX_CH_PROP);
+  });
+
+  bench("format_print", || {
+    let mut stream = print::new_string_format_buffer();
+    let _ = write!(
+      &mut stream,
+      "bench {} {:#x} {:>12}\n",
+      123456789u32, 0xc0ffeeu32, "fields"
+    );
+  });
+
+  dbg_print!("BENCH DONE\n");
+}
+
+/// @fn bench(name: &str, f: impl FnMut())
+/// @brief   Time a benchmark body and report its average cost.
+/// @param[in] name The benchmark name in the report line.
+/// @param[in] f    The body to time.
+fn bench(name: &str, mut f: impl FnMut()) {
+  f();
+
+  let start = profile::read_cycles();
+
+  for _ in 0..ITERATIONS {
+    f();
+  }
+
+  let cycles = profile::read_cycles().wrapping_sub(start) / ITERATIONS;
+  dbg_print!("BENCH {} {}\n", name, cycles);
+}
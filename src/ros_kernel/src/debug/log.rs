@@ -0,0 +1,157 @@
+use crate::arch;
+use crate::peripherals::uart;
+use crate::task;
+use core::cell::UnsafeCell;
+use core::sync::atomic::{AtomicU32, AtomicUsize, Ordering};
+
+/// @var RING_SIZE
+/// @brief Bytes per core ring; must be a power of two.
+const RING_SIZE: usize = 4096;
+
+/// @var MAX_CORES
+/// @brief Per-core rings; must cover every core ID.
+const MAX_CORES: usize = 4;
+
+/// @struct LogRing
+/// @brief   A lock-free single-producer, single-consumer byte ring.
+/// @details The producer is the code executing on the ring's core; the
+///          consumer is the drain task. Only the producer writes head and
+///          only the consumer writes tail, so a release store on the writer's
+///          index and an acquire load on the reader's side are the only
+///          synchronization. The indices count bytes forever and are masked
+///          into the buffer.
+/// @var buf      The ring buffer.
+/// @var head     The producer's write index.
+/// @var tail     The consumer's read index.
+/// @var dropped  Bytes dropped while the ring was full.
+/// @var reported The drop count already reported by the consumer.
+struct LogRing {
+  buf: UnsafeCell<[u8; RING_SIZE]>,
+  head: AtomicUsize,
+  tail: AtomicUsize,
+  dropped: AtomicU32,
+  reported: AtomicU32,
+}
+
+unsafe impl Sync for LogRing {}
+
+impl LogRing {
+  const fn new() -> Self {
+    LogRing {
+      buf: UnsafeCell::new([0; RING_SIZE]),
+      head: AtomicUsize::new(0),
+      tail: AtomicUsize::new(0),
+      dropped: AtomicU32::new(0),
+      reported: AtomicU32::new(0),
+    }
+  }
+}
+
+const EMPTY_RING: LogRing = LogRing::new();
+
+/// @var LOG_RINGS
+/// @brief The per-core log rings, indexed by core ID.
+static LOG_RINGS: [LogRing; MAX_CORES] = [EMPTY_RING; MAX_CORES];
+
+/// @fn write_bytes(bytes: &[u8])
+/// @brief   Push formatted log bytes onto the executing core's ring.
+/// @details Interrupts are masked across the push so an IRQ handler logging
+///          mid-push cannot interleave with the task it preempted; the cost
+///          is a copy into the ring, never a UART transmission. When the ring
+///          is full the bytes are dropped and counted.
+/// @param[in] bytes The bytes to log.
+#[link_section = ".text.hot"]
+pub fn write_bytes(bytes: &[u8]) {
+  let ring = &LOG_RINGS[arch::cpu::core_id()];
+  let state = arch::cpu::save_and_disable_interrupts();
+
+  let head = ring.head.load(Ordering::Relaxed);
+  let tail = ring.tail.load(Ordering::Acquire);
+  let free = RING_SIZE - (head - tail);
+
+  if bytes.len() > free {
+    ring
+      .dropped
+      .fetch_add(bytes.len() as u32, Ordering::Relaxed);
+  } else {
+    let buf = unsafe { &mut *ring.buf.get() };
+
+    for (i, b) in bytes.iter().enumerate() {
+      buf[(head + i) & (RING_SIZE - 1)] = *b;
+    }
+
+    ring.head.store(head + bytes.len(), Ordering::Release);
+  }
+
+  arch::cpu::restore_interrupts(state);
+}
+
+/// @fn drain()
+/// @brief   Empty every core's ring to the UART.
+/// @details Consumer side; must only run from one context at a time. Reports
+///          newly dropped bytes ahead of the ring contents.
+pub fn drain() {
+  drain_to(uart::uart_send_bytes);
+}
+
+/// @fn drain_blocking()
+/// @brief   Empty every core's ring straight out the UART wire.
+/// @details For contexts that never return to the drain task: the panic
+///          handler and unresolved traps. The queueing send would only stack
+///          bytes behind the transmit interrupt - and livelock once the ring
+///          fills with interrupts masked - so this spins on the FIFO instead.
+pub fn drain_blocking() {
+  drain_to(uart::uart_send_bytes_blocking);
+}
+
+/// @fn drain_to(send: fn(&[u8]))
+/// @brief   Empty every core's ring through the given send routine.
+/// @param[in] send The UART send routine.
+fn drain_to(send: fn(&[u8])) {
+  for core in 0..MAX_CORES {
+    let ring = &LOG_RINGS[core];
+
+    let dropped = ring.dropped.load(Ordering::Relaxed);
+    if dropped != ring.reported.load(Ordering::Relaxed) {
+      ring.reported.store(dropped, Ordering::Relaxed);
+      crate::dbg_print!("[log: core {} dropped {} bytes]\n", core, dropped);
+    }
+
+    loop {
+      let tail = ring.tail.load(Ordering::Relaxed);
+      let head = ring.head.load(Ordering::Acquire);
+
+      if head == tail {
+        break;
+      }
+
+      let mut chunk = [0; 64];
+      let count = (head - tail).min(chunk.len());
+      let buf = unsafe { &*ring.buf.get() };
+
+      for (i, b) in chunk[..count].iter_mut().enumerate() {
+        *b = buf[(tail + i) & (RING_SIZE - 1)];
+      }
+
+      ring.tail.store(tail + count, Ordering::Release);
+      send(&chunk[..count]);
+    }
+  }
+}
+
+/// @fn start_drain_task()
+/// @brief Create the low-priority drain task that empties the rings to the
+///        UART whenever it gets the CPU.
+pub fn start_drain_task() {
+  task::create_task(drain_task, 0);
+}
+
+/// @fn drain_task(arg: usize)
+/// @brief The drain task body.
+fn drain_task(_: usize) {
+  loop {
+    drain();
+    crate::drivers::video::console::flush();
+    task::schedule();
+  }
+}
@@ -1 +1,4 @@
+pub mod log;
 pub mod print;
+pub mod profile;
+pub mod trace;
@@ -1,15 +1,20 @@
-use crate::peripherals::mini_uart;
+use super::log;
 use crate::support::print;
 use core::fmt::{self, Write};
 
 /// @fn dbg_print(args: fmt::Arguments<'_>)
-/// @brief Formats the arguments to a string and writes it to the mini UART.
+/// @brief   Formats the arguments to a string and pushes it onto the
+///          executing core's log ring.
+/// @details Formats into a stack buffer, so it is safe from any context; the
+///          drain task gets the bytes to the mini UART later.
 /// @param[in] args The formatting arguments built by format_args!.
+#[link_section = ".text.hot"]
 pub fn dbg_print(args: fmt::Arguments<'_>) {
-  let mut stream = print::new_string_format_buffer();
+  let mut buf = [0; 256];
+  let mut stream = print::WriteBuffer::new(&mut buf);
   match stream.write_fmt(args) {
-    Ok(_) => mini_uart::uart_send_bytes(stream.as_bytes()),
-    _ => mini_uart::uart_send_string("Error: dbg_print Failed to format string.\n"),
+    Ok(_) => log::write_bytes(stream.as_bytes()),
+    _ => log::write_bytes("Error: dbg_print Failed to format string.\n".as_bytes()),
   }
 }
 
@@ -0,0 +1,116 @@
+use crate::arch;
+use crate::dbg_print;
+
+pub const STAT_MAILBOX_RTT: usize = 0;
+pub const STAT_PRINT_STRING: usize = 1;
+pub const STAT_IRQ_DISPATCH: usize = 2;
+pub const STAT_COUNT: usize = 3;
+
+/// @var STAT_NAMES
+/// @brief Display names for the hot-path stats, indexed by stat ID.
+const STAT_NAMES: [&str; STAT_COUNT] = ["mailbox rtt", "print_string", "irq dispatch"];
+
+/// @struct Stat
+/// @brief A named hot-path counter.
+/// @var count The number of recorded measurements.
+/// @var total The summed cycles across all measurements.
+/// @var max   The largest single measurement in cycles.
+struct Stat {
+  count: u64,
+  total: u64,
+  max: u64,
+}
+
+const EMPTY_STAT: Stat = Stat {
+  count: 0,
+  total: 0,
+  max: 0,
+};
+
+/// @var STATS
+/// @brief   The hot-path counters.
+/// @details Each stat is recorded from one context only — IRQ dispatch from
+///          the IRQ stack, the rest from task context — so the updates do not
+///          interleave. The kernel is single-threaded, so directly accessing
+///          the counters is safe.
+static mut STATS: [Stat; STAT_COUNT] = [EMPTY_STAT; STAT_COUNT];
+
+/// @fn init()
+/// @brief Enable the cycle counter on the executing core.
+pub fn init() {
+  arch::profile::init_cycle_counter();
+}
+
+/// @fn read_cycles() -> u64
+/// @brief   Read the core cycle counter.
+/// @returns The cycle count since init.
+pub fn read_cycles() -> u64 {
+  arch::profile::read_cycles()
+}
+
+/// @fn record(stat: usize, cycles: u64)
+/// @brief   Record one measurement against a stat.
+/// @param[in] stat   The stat ID.
+/// @param[in] cycles The measured cycles.
+pub fn record(stat: usize, cycles: u64) {
+  assert!(stat < STAT_COUNT);
+
+  unsafe {
+    STATS[stat].count += 1;
+    STATS[stat].total += cycles;
+
+    if cycles > STATS[stat].max {
+      STATS[stat].max = cycles;
+    }
+  }
+}
+
+/// @struct Scope
+/// @brief   A scoped measurement guard.
+/// @details Reads the cycle counter on entry and records the elapsed cycles
+///          against its stat when dropped, so a single binding at the top of
+///          a function measures the whole body.
+pub struct Scope {
+  stat: usize,
+  start: u64,
+}
+
+impl Scope {
+  /// @fn enter(stat: usize) -> Scope
+  /// @brief   Start a scoped measurement.
+  /// @param[in] stat The stat ID to record against.
+  /// @returns The guard; keep it alive for the measured region.
+  pub fn enter(stat: usize) -> Self {
+    Scope {
+      stat,
+      start: read_cycles(),
+    }
+  }
+}
+
+impl Drop for Scope {
+  fn drop(&mut self) {
+    record(self.stat, read_cycles().wrapping_sub(self.start));
+  }
+}
+
+/// @fn dump()
+/// @brief Dump every stat's count, total, average, and maximum cycles over
+///        the mini UART.
+pub fn dump() {
+  dbg_print!("--- kernel stats (cycles) ---\n");
+
+  for stat in 0..STAT_COUNT {
+    let (count, total, max) = unsafe { (STATS[stat].count, STATS[stat].total, STATS[stat].max) };
+    let avg = if count > 0 { total / count } else { 0 };
+
+    dbg_print!(
+      "{:<16} count: {:<10} total: {:<12} avg: {:<10} max: {}\n",
+      STAT_NAMES[stat],
+      count,
+      total,
+      avg,
+      max
+    );
+  }
+}
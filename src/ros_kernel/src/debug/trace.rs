@@ -0,0 +1,147 @@
+#[cfg(feature = "trace")]
+use crate::debug::profile;
+#[cfg(feature = "trace")]
+use crate::support::per_core::MAX_CORES;
+
+pub const EVT_MAILBOX_SEND: u32 = 0;
+pub const EVT_FB_INIT: u32 = 1;
+pub const EVT_UART_SEND: u32 = 2;
+pub const EVT_IRQ_ENTRY: u32 = 3;
+pub const EVT_TRAP_ENTRY: u32 = 4;
+
+/// @var EVT_COUNT
+/// @brief Number of event IDs; IDs at or above this dump as raw numbers.
+pub const EVT_COUNT: usize = 5;
+
+/// @var EVT_NAMES
+/// @brief Event names for the dump, indexed by event ID.
+const EVT_NAMES: [&str; EVT_COUNT] = [
+  "mailbox_send",
+  "fb_init",
+  "uart_send",
+  "irq_entry",
+  "trap_entry",
+];
+
+/// @var RING_SIZE
+/// @brief Records in the trace ring; must be a power of two.
+#[cfg(feature = "trace")]
+const RING_SIZE: usize = 1024;
+
+/// @struct TraceRecord
+/// @brief   One fixed-size trace record.
+/// @details The layout pairs with the trace_dump command in the GDB scripts;
+///          keep them in sync.
+/// @var cycles The PMU cycle count at the tracepoint.
+/// @var event  The event ID.
+/// @var arg    The tracepoint's argument.
+#[repr(C)]
+#[cfg(feature = "trace")]
+#[derive(Copy, Clone)]
+struct TraceRecord {
+  cycles: u64,
+  event: u32,
+  arg: u32,
+}
+
+#[cfg(feature = "trace")]
+const EMPTY_RECORD: TraceRecord = TraceRecord {
+  cycles: 0,
+  event: 0,
+  arg: 0,
+};
+
+/// @var TRACE_RECORDS
+/// @brief   The per-core trace rings, indexed by core ID.
+/// @details Flat arrays rather than PerCore slots so the GDB scripts can
+///          read the rings out of a halted target with plain indexing; each
+///          core only writes its own ring, with interrupts masked, so
+///          directly accessing it is safe.
+#[cfg(feature = "trace")]
+#[no_mangle]
+static mut TRACE_RECORDS: [[TraceRecord; RING_SIZE]; MAX_CORES] =
+  [[EMPTY_RECORD; RING_SIZE]; MAX_CORES];
+
+/// @var TRACE_HEADS
+/// @brief The per-core monotonic record counts; masked into the rings.
+///        Unmangled for the GDB scripts.
+#[cfg(feature = "trace")]
+#[no_mangle]
+static mut TRACE_HEADS: [usize; MAX_CORES] = [0; MAX_CORES];
+
+/// @fn record(event: u32, arg: u32)
+/// @brief   Append a record to the trace ring.
+/// @details The cost is a cycle counter read and a 16-byte store with
+///          interrupts masked briefly, tens of cycles, so tracepoints do not
+///          perturb the latencies they measure the way dbg_print does. The
+///          ring overwrites its oldest records.
+/// @param[in] event The event ID.
+/// @param[in] arg   The tracepoint's argument.
+#[cfg(feature = "trace")]
+pub fn record(event: u32, arg: u32) {
+  let core = crate::arch::cpu::core_id();
+  let state = crate::arch::cpu::save_and_disable_interrupts();
+
+  unsafe {
+    TRACE_RECORDS[core][TRACE_HEADS[core] & (RING_SIZE - 1)] = TraceRecord {
+      cycles: profile::read_cycles(),
+      event,
+      arg,
+    };
+
+    TRACE_HEADS[core] += 1;
+  }
+
+  crate::arch::cpu::restore_interrupts(state);
+}
+
+/// @fn dump()
+/// @brief Print every core's records, oldest first, to the kernel log.
+#[cfg(feature = "trace")]
+pub fn dump() {
+  use crate::dbg_print;
+
+  unsafe {
+    for core in 0..MAX_CORES {
+      let head = TRACE_HEADS[core];
+      let start = head.saturating_sub(RING_SIZE);
+
+      dbg_print!("TRACE core {}: {} records\n", core, head - start);
+
+      for i in start..head {
+        let r = &TRACE_RECORDS[core][i & (RING_SIZE - 1)];
+
+        if (r.event as usize) < EVT_COUNT {
+          dbg_print!(
+            "TRACE {:>12} {} {:#x}\n",
+            r.cycles,
+            EVT_NAMES[r.event as usize],
+            r.arg
+          );
+        } else {
+          dbg_print!("TRACE {:>12} {} {:#x}\n", r.cycles, r.event, r.arg);
+        }
+      }
+    }
+  }
+}
+
+/// @fn dump()
+/// @brief No-op when tracing is compiled out.
+#[cfg(not(feature = "trace"))]
+pub fn dump() {}
+
+/// @def trace!
+/// @brief   Append a trace record with an optional argument.
+/// @details Expands to nothing unless the trace feature is enabled, so
+///          tracepoints can stay in the hot paths permanently.
+#[macro_export]
+macro_rules! trace {
+  ($event:expr) => {
+    $crate::trace!($event, 0)
+  };
+  ($event:expr, $arg:expr) => {{
+    #[cfg(feature = "trace")]
+    $crate::debug::trace::record($event, $arg as u32);
+  }};
+}
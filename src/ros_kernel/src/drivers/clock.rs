@@ -0,0 +1,122 @@
+use crate::dbg_print;
+use crate::peripherals::mailbox;
+
+pub const CLOCK_UART: u32 = 0x2;
+pub const CLOCK_ARM: u32 = 0x3;
+pub const CLOCK_CORE: u32 = 0x4;
+pub const CLOCK_V3D: u32 = 0x5;
+
+/// @var CLOCK_COUNT
+/// @brief Number of clocks the governor tracks; the IDs above index RATES.
+const CLOCK_COUNT: usize = 6;
+
+/// @var CLK_RSP_RATE
+/// @brief Response index of the rate in a single-tag clock message; the
+///        values are [clock ID, rate].
+const CLK_RSP_RATE: usize = 6;
+
+/// @enum Profile
+/// @brief The boot clock profile.
+#[derive(Copy, Clone, PartialEq)]
+pub enum Profile {
+  /// Raise the ARM core clock to its maximum; leave the rest at the
+  /// firmware's defaults.
+  Balanced,
+  /// Raise the ARM core, GPU core, and V3D clocks to their maximums.
+  MaxPerformance,
+}
+
+/// @var RATES
+/// @brief   Current clock rates in Hz, indexed by clock ID; 0 until init
+///          queries them.
+/// @details The kernel is single-threaded during boot, so directly accessing
+///          the rates is safe.
+static mut RATES: [u32; CLOCK_COUNT] = [0; CLOCK_COUNT];
+
+/// @fn init(profile: Profile)
+/// @brief   Apply the boot clock profile and cache the resulting rates.
+/// @details The firmware boots the ARM clock at a conservative default and
+///          nothing else in this stack ever raises it, so the governor does
+///          it here. Runs on the blocking mailbox path; boot only.
+/// @param[in] profile The profile to apply.
+#[link_section = ".text.init"]
+pub fn init(profile: Profile) {
+  set_rate(CLOCK_ARM, get_max_rate(CLOCK_ARM));
+
+  if profile == Profile::MaxPerformance {
+    set_rate(CLOCK_CORE, get_max_rate(CLOCK_CORE));
+    set_rate(CLOCK_V3D, get_max_rate(CLOCK_V3D));
+  }
+
+  for clock in [CLOCK_UART, CLOCK_ARM, CLOCK_CORE, CLOCK_V3D] {
+    let rate = get_rate(clock);
+
+    unsafe {
+      RATES[clock as usize] = rate;
+    }
+  }
+
+  dbg_print!(
+    "Clocks (Hz): arm={} core={} v3d={} uart={}\n",
+    current_rate(CLOCK_ARM),
+    current_rate(CLOCK_CORE),
+    current_rate(CLOCK_V3D),
+    current_rate(CLOCK_UART)
+  );
+}
+
+/// @fn current_rate(clock: u32) -> u32
+/// @brief   Get a clock's rate as cached at init.
+/// @details For calibration code that needs a rate without a mailbox round
+///          trip, e.g. deriving UART baud divisors.
+/// @param[in] clock The clock ID.
+/// @returns The rate in Hz, or 0 before init.
+pub fn current_rate(clock: u32) -> u32 {
+  assert!((clock as usize) < CLOCK_COUNT);
+  unsafe { RATES[clock as usize] }
+}
+
+/// @fn get_rate(clock: u32) -> u32
+/// @brief   Query a clock's rate from the VideoCore.
+/// @param[in] clock The clock ID.
+/// @returns The rate in Hz, or 0 if the query fails.
+fn get_rate(clock: u32) -> u32 {
+  clock_request(mailbox::MBOX_TAG_GETCLKRATE, &[clock, 0])
+}
+
+/// @fn get_max_rate(clock: u32) -> u32
+/// @brief   Query a clock's maximum supported rate from the VideoCore.
+/// @param[in] clock The clock ID.
+/// @returns The rate in Hz, or 0 if the query fails.
+fn get_max_rate(clock: u32) -> u32 {
+  clock_request(mailbox::MBOX_TAG_GETMAXCLKRATE, &[clock, 0])
+}
+
+/// @fn set_rate(clock: u32, rate: u32)
+/// @brief   Set a clock's rate.
+/// @details The third value word leaves turbo handling to the firmware. A
+///          rate of 0 is ignored rather than handed to the firmware.
+/// @param[in] clock The clock ID.
+/// @param[in] rate  The rate in Hz.
+fn set_rate(clock: u32, rate: u32) {
+  if rate == 0 {
+    return;
+  }
+
+  clock_request(mailbox::MBOX_TAG_SETCLKRATE, &[clock, rate, 0]);
+}
+
+/// @fn clock_request(tag: u32, values: &[u32]) -> u32
+/// @brief   Send a single-tag clock property request.
+/// @param[in] tag    The clock property tag.
+/// @param[in] values The tag's value words, starting with the clock ID.
+/// @returns The rate word of the response, or 0 if the request fails.
+fn clock_request(tag: u32, values: &[u32]) -> u32 {
+  *mailbox::get_buffer_mut() = mailbox::MessageBuilder::new().tag(tag, values).build();
+
+  if !mailbox::send(mailbox::MBOX_CH_PROP) {
+    return 0;
+  }
+
+  mailbox::get_buffer()[CLK_RSP_RATE]
+}
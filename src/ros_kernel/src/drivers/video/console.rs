@@ -1,9 +1,10 @@
 use super::framebuffer;
+use crate::debug::profile;
+use crate::peripherals::dma;
+use crate::support::mem;
 use crate::support::print;
 use core::convert::TryFrom;
 use core::fmt::{self, Write};
-use core::mem;
-use core::ptr;
 
 const VGA_PAL: [u32; 16] = [
   0x000000, 0x0000AA, 0x00AA00, 0x00AAAA, 0xAA0000, 0xAA00AA, 0xAA5500, 0xAAAAAA, 0x555555,
@@ -275,119 +276,367 @@ const FONT_GLYPHS: [[u8; FONT_BPG]; FONT_NUMGLYPHS] = [
   [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00],
 ];
 
+/// @var MAX_COLS
+/// @brief Maximum console columns; 240 covers 1920 pixels at 8 per glyph.
+const MAX_COLS: usize = 240;
+
+/// @var MAX_ROWS
+/// @brief Maximum console rows; 135 covers 1080 pixels at 8 per glyph.
+const MAX_ROWS: usize = 135;
+
+/// @struct Cell
+/// @brief A character cell in the console's shadow grid.
+/// @var ch   The character occupying the cell.
+/// @var attr The attribute byte the cell was drawn with.
+#[derive(Copy, Clone)]
+struct Cell {
+  ch: u8,
+  attr: u8,
+}
+
+const BLANK_CELL: Cell = Cell { ch: 0, attr: 0 };
+
+/// @struct Console
+/// @brief Console state in character cells rather than pixels.
+/// @var col     Cursor column.
+/// @var row     Cursor row.
+/// @var cols    Console width in cells; 0 until the console is initialized.
+/// @var rows    Console height in cells.
+/// @var pan_row Text rows the display is panned down into the virtual buffer.
 struct Console {
-  x: u32,
-  y: u32,
+  col: u32,
+  row: u32,
+  cols: u32,
+  rows: u32,
+  pan_row: u32,
+}
+
+#[link_section = ".data.hot"]
+static mut CONSOLE: Console = Console {
+  col: 0,
+  row: 0,
+  cols: 0,
+  rows: 0,
+  pan_row: 0,
+};
+
+/// @var SHADOW
+/// @brief   Character-cell shadow of the console contents.
+/// @details Scrolling and repaints work from the shadow grid instead of
+///          reading the framebuffer back. Printers and the drain task's flush
+///          interleave preemptively, but every shadow write is followed by
+///          setting the row's dirty flag: a flush that races a write at worst
+///          paints stale cells, and the still-set flag repaints them on the
+///          next pass.
+static mut SHADOW: [[Cell; MAX_COLS]; MAX_ROWS] = [[BLANK_CELL; MAX_COLS]; MAX_ROWS];
+
+const GLYPH_PIXELS: usize = FONT_WIDTH * FONT_HEIGHT;
+
+/// @struct GlyphCacheEntry
+/// @brief A glyph pre-rendered through the VGA palette.
+/// @var attr   The attribute byte the glyph was rendered with.
+/// @var valid  True once the entry holds a rendered glyph.
+/// @var pixels The rendered 32-bit pixels, row-major.
+struct GlyphCacheEntry {
+  attr: u8,
+  valid: bool,
+  pixels: [u32; GLYPH_PIXELS],
 }
 
-static mut CONSOLE: Console = Console { x: 0, y: 0 };
+const GLYPH_CACHE_EMPTY: GlyphCacheEntry = GlyphCacheEntry {
+  attr: 0,
+  valid: false,
+  pixels: [0; GLYPH_PIXELS],
+};
+
+/// @var GLYPH_CACHE
+/// @brief   Pre-rendered glyphs indexed by character.
+/// @details Each character is cached for the attribute it was last drawn
+///          with, which covers the common case of the whole console using one
+///          attribute. Only the drain task's flush renders glyphs, so the
+///          cache has a single user.
+static mut GLYPH_CACHE: [GlyphCacheEntry; FONT_NUMGLYPHS] = [GLYPH_CACHE_EMPTY; FONT_NUMGLYPHS];
+
+/// @fn get_glyph(ch: usize, attr: u8) -> &'static [u32; GLYPH_PIXELS]
+/// @brief   Get the rendered pixels for a (character, attribute) pair.
+/// @details On a cache miss, expands the glyph bit-by-bit through the palette
+///          and caches the result. Subsequent prints of the same pair reuse
+///          the cached pixels.
+/// @param[in] ch   The character.
+/// @param[in] attr The font colors. See @a print_string.
+/// @returns The rendered 32-bit pixels, row-major.
+fn get_glyph(ch: usize, attr: u8) -> &'static [u32; GLYPH_PIXELS] {
+  let entry = unsafe { &mut GLYPH_CACHE[ch] };
+
+  if !entry.valid || entry.attr != attr {
+    let fg = VGA_PAL[(attr & 0x0f) as usize];
+    let bg = VGA_PAL[((attr & 0xf0) >> 4) as usize];
+
+    for r in 0..FONT_HEIGHT {
+      for c in 0..FONT_WIDTH {
+        let mask = 1 << c;
+        entry.pixels[(r * FONT_WIDTH) + c] = if (FONT_GLYPHS[ch][r] & mask) != 0 {
+          fg
+        } else {
+          bg
+        };
+      }
+    }
+
+    entry.attr = attr;
+    entry.valid = true;
+  }
+
+  &entry.pixels
+}
+
+/// @fn fill_pixels(dst: usize, size: usize)
+/// @brief   Zero a stretch of framebuffer pixels.
+/// @details Issues a DMA fill and yields until it completes; falls back to
+///          the CPU fill when the engine is unavailable or busy.
+/// @param[in] dst  The destination; word aligned.
+/// @param[in] size The size in bytes.
+fn fill_pixels(dst: usize, size: usize) {
+  if let Some(handle) = dma::fill(dst, 0, size, None) {
+    dma::wait(handle);
+  } else {
+    mem::fill_words(dst as *mut u32, 0, size / 4);
+  }
+}
 
 /// @fn clear()
-/// @brief Clear the frame buffer.
+/// @brief   Clear the console and reset the cursor and display pan.
+/// @details The pixel clear goes to the DMA engine when it is up, yielding to
+///          other tasks while it runs; otherwise the CPU fills in place.
 pub fn clear() {
   let fb = framebuffer::get_fb();
-  let h = fb.height as usize;
+  let h = fb.virtual_height as usize;
   let p = fb.pitch as usize;
 
   unsafe {
-    ptr::write_bytes(fb.fb_ptr, 0, h * p);
-    CONSOLE.x = 0;
-    CONSOLE.y = 0;
+    fill_pixels(fb.fb_ptr as usize, h * p);
+
+    for row in SHADOW.iter_mut() {
+      for cell in row.iter_mut() {
+        *cell = BLANK_CELL;
+      }
+    }
+
+    for dirty in DIRTY.iter_mut() {
+      *dirty = false;
+    }
+
+    CONSOLE.col = 0;
+    CONSOLE.row = 0;
+    CONSOLE.cols = (fb.width / u32::try_from(FONT_WIDTH).unwrap()).min(MAX_COLS as u32);
+    CONSOLE.rows = (fb.height / u32::try_from(FONT_HEIGHT).unwrap()).min(MAX_ROWS as u32);
+
+    if CONSOLE.pan_row != 0 {
+      CONSOLE.pan_row = 0;
+      framebuffer::fb_set_virtual_offset(0);
+    }
+  }
+}
+
+/// @var ROW_PIXELS
+/// @brief Pixels per staging buffer line; one full console row of glyphs.
+const ROW_PIXELS: usize = MAX_COLS * FONT_WIDTH;
+
+/// @var STAGING
+/// @brief   Staging buffer holding one rendered text row.
+/// @details Glyphs are rendered here contiguously and the row goes to the
+///          framebuffer with one copy per pixel line, instead of a clamped
+///          per-character write. Only the drain task's flush renders rows, so
+///          the buffer has a single user.
+static mut STAGING: [u32; ROW_PIXELS * FONT_HEIGHT] = [0; ROW_PIXELS * FONT_HEIGHT];
+
+/// @var DIRTY
+/// @brief Text rows whose shadow cells have changed since the last flush.
+static mut DIRTY: [bool; MAX_ROWS] = [false; MAX_ROWS];
+
+/// @fn mark_dirty(r: u32)
+/// @brief   Mark a text row for the next flush.
+/// @param[in] r The cell row.
+fn mark_dirty(r: u32) {
+  unsafe {
+    DIRTY[r as usize] = true;
+  }
+}
+
+/// @fn mark_all_dirty()
+/// @brief Mark every text row for the next flush.
+fn mark_all_dirty() {
+  unsafe {
+    for dirty in DIRTY.iter_mut() {
+      *dirty = true;
+    }
   }
 }
 
-/// @fn print_char(fb: &framebuffer::Framebuffer, ch: u8, x: u32, y: u32, attr: u8)
-/// @brief Print a character to a framebuffer using the default font.
-/// @param[in] fb   The framebuffer for output.
-/// @param[in] ch   The character to print.
-/// @param[in] x    The x position on the screen in pixels.
-/// @param[in] y    The y position on the screen in pixels.
-/// @param[in] attr The font colors. The high nibble is the index in to the VGA
-///                 palette for the background, and the low nibble is the index
-///                 for the foreground.
-fn print_char(fb: &framebuffer::Framebuffer, ch: u8, x: u32, y: u32, attr: u8) {
+/// @fn flush()
+/// @brief   Repaint the dirty text rows from the shadow grid.
+/// @details Printing only updates the shadow grid and marks rows dirty, so
+///          every kprint since the last flush coalesces into this one
+///          repaint. The drain task flushes once per scheduling quantum.
+pub fn flush() {
+  let fb = framebuffer::get_fb();
+
   if fb.width == 0 || fb.height == 0 {
     return;
   }
 
-  let x = isize::try_from(x.clamp(0, fb.width - 1)).unwrap();
-  let y = isize::try_from(y.clamp(0, fb.height - 1)).unwrap();
-  let p = isize::try_from(fb.pitch).unwrap();
-  let mut offs = (y * p) + (x * 4);
-  let ch = ch as usize;
+  let rows = unsafe { CONSOLE.rows };
 
-  for r in 0..FONT_HEIGHT {
-    let mut row: [u32; FONT_WIDTH] = [0; FONT_WIDTH];
+  for r in 0..rows {
+    unsafe {
+      if !DIRTY[r as usize] {
+        continue;
+      }
 
-    for c in 0..FONT_WIDTH {
-      let mask = 1 << c;
-      let px: usize = if (FONT_GLYPHS[ch][r] & mask) != 0 {
-        (attr & 0x0f).into()
-      } else {
-        ((attr & 0xf0) >> 4).into()
-      };
+      DIRTY[r as usize] = false;
+    }
 
-      row[c] = VGA_PAL[px];
+    render_row(fb, r);
+  }
+}
+
+/// @fn render_row(fb: &framebuffer::Framebuffer, r: u32)
+/// @brief   Render one text row through the staging buffer.
+/// @details Renders the row's glyphs contiguously into the staging buffer,
+///          then writes it out with a single copy per pixel line, accounting
+///          for the current display pan.
+/// @param[in] fb The framebuffer for output.
+/// @param[in] r  The cell row.
+fn render_row(fb: &framebuffer::Framebuffer, r: u32) {
+  let (cols, pan) = unsafe { (CONSOLE.cols as usize, CONSOLE.pan_row) };
+
+  for c in 0..cols {
+    let cell = unsafe { SHADOW[r as usize][c] };
+    let glyph = get_glyph(cell.ch as usize, cell.attr);
+
+    for gr in 0..FONT_HEIGHT {
+      let line = unsafe { &mut STAGING[(gr * ROW_PIXELS) + (c * FONT_WIDTH)..] };
+      line[..FONT_WIDTH].copy_from_slice(&glyph[(gr * FONT_WIDTH)..((gr + 1) * FONT_WIDTH)]);
     }
+  }
 
+  let p = fb.pitch as usize;
+  let y = ((pan + r) as usize) * FONT_HEIGHT;
+  let width = cols * FONT_WIDTH * 4;
+
+  for gr in 0..FONT_HEIGHT {
     unsafe {
-      core::ptr::copy(
-        row.as_ptr() as *const u8,
-        fb.fb_ptr.offset(offs),
-        mem::size_of_val(&row),
+      mem::copy(
+        fb.fb_ptr.add((y + gr) * p),
+        (&STAGING[gr * ROW_PIXELS..]).as_ptr() as *const u8,
+        width,
       );
     }
-
-    offs = offs + p;
   }
 }
 
 /// @fn scroll_console(fb: &framebuffer::Framebuffer)
-/// @brief Scroll a framebuffer up one line.
+/// @brief   Scroll the console up one text row.
+/// @details Shifts the shadow grid up, then pans the VideoCore virtual offset
+///          down one row, which costs a single mailbox call. When the virtual
+///          buffer runs out, the console repaints once from the shadow grid at
+///          pan zero and starts over. If the VideoCore did not grant extra
+///          virtual height, every scroll takes the repaint path.
 /// @param[in] fb The framebuffer to scroll.
 fn scroll_console(fb: &framebuffer::Framebuffer) {
-  let p = (fb.pitch as isize) * (FONT_HEIGHT as isize);
-  let bytes = (fb.pitch as usize) * (fb.height as usize) - (p as usize);
+  let glyph_height = u32::try_from(FONT_HEIGHT).unwrap();
+  let (cols, rows) = unsafe { (CONSOLE.cols as usize, CONSOLE.rows as usize) };
 
   unsafe {
-    core::ptr::copy(fb.fb_ptr.offset(p), fb.fb_ptr, bytes);
+    for r in 1..rows {
+      for c in 0..cols {
+        SHADOW[r - 1][c] = SHADOW[r][c];
+      }
+    }
+
+    for c in 0..cols {
+      SHADOW[rows - 1][c] = BLANK_CELL;
+    }
+  }
+
+  let max_pan = (fb.virtual_height - fb.height) / glyph_height;
+  let pan = unsafe { CONSOLE.pan_row };
+
+  if pan < max_pan {
+    unsafe {
+      CONSOLE.pan_row = pan + 1;
+
+      // Clear the band exposed at the bottom before panning to it.
+      let band = ((CONSOLE.pan_row + CONSOLE.rows - 1) * glyph_height) as usize;
+      let p = fb.pitch as usize;
+      fill_pixels(fb.fb_ptr.add(band * p) as usize, p * FONT_HEIGHT);
+
+      framebuffer::fb_set_virtual_offset(CONSOLE.pan_row * glyph_height);
+
+      // After the pan, the displayed pixels already match the shifted shadow;
+      // only the cleared bottom row needs a repaint.
+      mark_dirty(CONSOLE.rows - 1);
+    }
+  } else {
+    unsafe {
+      CONSOLE.pan_row = 0;
+    }
+
+    // Wrapping back to pan zero moves every row's pixels; repaint the grid.
+    mark_all_dirty();
+    framebuffer::fb_set_virtual_offset(0);
   }
 }
 
 /// @fn print_string(s: &[u8], attr: u8)
-/// @brief Print a string to the console.
+/// @brief   Print a string to the console.
+/// @details Only updates the shadow grid and the dirty row set; rendering is
+///          deferred to flush, which batches whole rows through the staging
+///          buffer.
 /// @param[in] s    An array of single-byte, characters to print.
-/// @param[in] attr The font colors. See @a print_char.
+/// @param[in] attr The font colors. The high nibble is the index in to the
+///                 VGA palette for the background, and the low nibble is the
+///                 index for the foreground.
+#[link_section = ".text.hot"]
 fn print_string(s: &[u8], attr: u8) {
-  let (mut r, mut c) = unsafe { (CONSOLE.y, CONSOLE.x) };
-  let x_inc: u32 = u32::try_from(FONT_WIDTH).unwrap();
-  let y_inc: u32 = u32::try_from(FONT_HEIGHT).unwrap();
+  let _scope = profile::Scope::enter(profile::STAT_PRINT_STRING);
   let fb = framebuffer::get_fb();
 
+  if fb.width == 0 || fb.height == 0 {
+    return;
+  }
+
+  let (mut r, mut c) = unsafe { (CONSOLE.row, CONSOLE.col) };
+  let (cols, rows) = unsafe { (CONSOLE.cols, CONSOLE.rows) };
+
   for b in s {
-    if c >= fb.width {
+    if c >= cols {
       c = 0;
-      r = r + y_inc;
+      r = r + 1;
     }
 
-    while r >= fb.height {
+    while r >= rows {
       scroll_console(fb);
-      r = r - y_inc;
+      r = r - 1;
     }
 
     if *b == 0xd {
       c = 0;
     } else if *b == 0xa {
       c = 0;
-      r = r + y_inc;
+      r = r + 1;
     } else {
-      print_char(fb, *b, c, r, attr);
-      c = c + x_inc;
+      unsafe {
+        SHADOW[r as usize][c as usize] = Cell { ch: *b, attr };
+      }
+
+      mark_dirty(r);
+      c = c + 1;
     }
   }
 
   unsafe {
-    (CONSOLE.y, CONSOLE.x) = (r, c);
+    (CONSOLE.row, CONSOLE.col) = (r, c);
   }
 }
 
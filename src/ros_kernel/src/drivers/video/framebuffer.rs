@@ -1,3 +1,4 @@
+use crate::arch;
 use crate::dbg_print;
 use crate::peripherals::mailbox;
 use core::ptr;
@@ -5,23 +6,48 @@ use core::ptr;
 const DEFAULT_WIDTH: u32 = 1920;
 const DEFAULT_HEIGHT: u32 = 1080;
 
+/// @var FB_ALIGN
+/// @brief   Requested framebuffer allocation alignment: 2 MiB.
+/// @details Aligning the allocation to the identity map's block size lets
+///          fb_init retag the whole buffer write-combining without touching
+///          any neighboring VideoCore memory.
+const FB_ALIGN: u32 = 0x200000;
+
+/// @var VIRTUAL_MULTIPLE
+/// @brief   Requested ratio of virtual height to physical height.
+/// @details A virtual buffer taller than the display lets the console scroll
+///          by panning the VideoCore virtual offset instead of moving pixels.
+const VIRTUAL_MULTIPLE: u32 = 2;
+
+/// @struct Framebuffer
+/// @brief The active framebuffer configuration.
+/// @var fb_ptr         ARM pointer to the (virtual-sized) pixel buffer.
+/// @var width          Physical width in pixels.
+/// @var height         Physical height in pixels.
+/// @var virtual_height Virtual height in pixels; at least @a height.
+/// @var pitch          Bytes per pixel row.
 pub struct Framebuffer {
   pub fb_ptr: *mut u8,
   pub width: u32,
   pub height: u32,
+  pub virtual_height: u32,
   pub pitch: u32,
   pub _isrgb: u32,
 }
 
+#[link_section = ".data.hot"]
 static mut FRAMEBUFFER: Framebuffer = Framebuffer {
   fb_ptr: ptr::null_mut(),
   width: 0,
   height: 0,
+  virtual_height: 0,
   pitch: 0,
   _isrgb: 0,
 };
 
+#[link_section = ".text.init"]
 pub fn fb_init() {
+  crate::trace!(crate::debug::trace::EVT_FB_INIT);
   // Setup the framebuffer properties and send them to the VideoCore.
   configure_properties();
 
@@ -32,15 +58,24 @@ pub fn fb_init() {
     // Verify we have a buffer with 32-bit depth and a pointer. Convert the
     // pointer into an ARM pointer.
     unsafe {
-      if buf[20] == 32 && buf[28] != 0 {
+      if buf[FB_RSP_DEPTH] == 32 && buf[FB_RSP_FB_PTR] != 0 {
         FRAMEBUFFER = Framebuffer {
-          fb_ptr: (buf[28] & 0x3FFFFFFF) as *mut u8,
-          width: buf[10],
-          height: buf[11],
-          pitch: buf[33],
-          _isrgb: buf[24],
+          fb_ptr: (buf[FB_RSP_FB_PTR] & 0x3FFFFFFF) as *mut u8,
+          width: buf[FB_RSP_WIDTH],
+          height: buf[FB_RSP_HEIGHT],
+          virtual_height: buf[FB_RSP_VIRT_HEIGHT].max(buf[FB_RSP_HEIGHT]),
+          pitch: buf[FB_RSP_PITCH],
+          _isrgb: buf[FB_RSP_PXLORDR],
         };
 
+        // Retag the buffer write-combining: merging streaming stores beats
+        // both a device-ordered and a cacheable mapping for pixel pushing,
+        // and it keeps the VideoCore coherent without cache maintenance.
+        arch::cpu::remap_write_combine(
+          FRAMEBUFFER.fb_ptr as usize,
+          (FRAMEBUFFER.pitch * FRAMEBUFFER.virtual_height) as usize,
+        );
+
         dbg_print!(
           "Initialized framebuffer at {}x{}.\n",
           FRAMEBUFFER.width,
@@ -60,51 +95,70 @@ pub fn get_fb() -> &'static Framebuffer {
   }
 }
 
+/// @fn fb_set_virtual_offset(y: u32) -> bool
+/// @brief   Pan the display to the given row of the virtual buffer.
+/// @details Submits the pan asynchronously so scrolling does not stall for
+///          the GPU round-trip; the buffer frees itself on completion. Falls
+///          back to a blocking call if the pool is exhausted.
+/// @param[in] y The first virtual pixel row to display.
+/// @returns True if the pan was submitted or accepted.
+pub fn fb_set_virtual_offset(y: u32) -> bool {
+  let handle = match mailbox::alloc_buffer() {
+    Some(handle) => handle,
+    None => {
+      let buf = mailbox::get_buffer_mut();
+      fill_virtual_offset(buf, y);
+      return mailbox::send(mailbox::MBOX_CH_PROP);
+    }
+  };
+
+  fill_virtual_offset(mailbox::buffer_mut(handle), y);
+  mailbox::submit(handle, mailbox::MBOX_CH_PROP, Some(mailbox::free_buffer));
+
+  true
+}
+
+/// @fn fill_virtual_offset(buf: &mut mailbox::Mail, y: u32)
+/// @brief Fill out a SETVIRTOFF property message.
+/// @param[in] buf The property buffer.
+/// @param[in] y   The first virtual pixel row to display.
+fn fill_virtual_offset(buf: &mut mailbox::Mail, y: u32) {
+  *buf = mailbox::MessageBuilder::new()
+    .tag(mailbox::MBOX_TAG_SETVIRTOFF, &[0, y])
+    .build();
+}
+
+/// @var FB_SETUP
+/// @brief   The framebuffer setup message, prebuilt at compile time.
+/// @details The FB_RSP_* constants index the response values; they follow
+///          directly from the tag order here.
+const FB_SETUP: mailbox::Mail = mailbox::MessageBuilder::new()
+  .tag(mailbox::MBOX_TAG_SETPHYWH, &[DEFAULT_WIDTH, DEFAULT_HEIGHT])
+  .tag(
+    mailbox::MBOX_TAG_SETVIRTWH,
+    &[DEFAULT_WIDTH, DEFAULT_HEIGHT * VIRTUAL_MULTIPLE],
+  )
+  .tag(mailbox::MBOX_TAG_SETVIRTOFF, &[0, 0])
+  .tag(mailbox::MBOX_TAG_SETDEPTH, &[32])
+  .tag(mailbox::MBOX_TAG_SETPXLORDR, &[1])
+  .tag(mailbox::MBOX_TAG_GETFB, &[FB_ALIGN, 0])
+  .tag(mailbox::MBOX_TAG_GETPITCH, &[0])
+  .build();
+
+const FB_RSP_WIDTH: usize = 5;
+const FB_RSP_HEIGHT: usize = 6;
+const FB_RSP_VIRT_HEIGHT: usize = 11;
+const FB_RSP_DEPTH: usize = 20;
+const FB_RSP_PXLORDR: usize = 24;
+const FB_RSP_FB_PTR: usize = 28;
+const FB_RSP_PITCH: usize = 33;
+
+/// @fn configure_properties()
+/// @brief   Stage the framebuffer setup message.
+/// @details The VideoCore writes its responses into the message in place,
+///          so the prebuilt image is copied into the mailbox buffer rather
+///          than sent directly.
+#[link_section = ".text.init"]
 fn configure_properties() {
-  let buf = mailbox::get_buffer_mut();
-
-  buf[0] = 36 * 4;
-  buf[1] = mailbox::MBOX_REQUEST;
-
-  buf[2] = mailbox::MBOX_TAG_SETPHYWH;
-  buf[3] = 8;
-  buf[4] = 8;
-  buf[5] = DEFAULT_WIDTH;
-  buf[6] = DEFAULT_HEIGHT;
-
-  buf[7] = mailbox::MBOX_TAG_SETVIRTWH;
-  buf[8] = 8;
-  buf[9] = 8;
-  buf[10] = DEFAULT_WIDTH;
-  buf[11] = DEFAULT_HEIGHT;
-
-  buf[12] = mailbox::MBOX_TAG_SETVIRTOFF;
-  buf[13] = 8;
-  buf[14] = 8;
-  buf[15] = 0;
-  buf[16] = 0;
-
-  buf[17] = mailbox::MBOX_TAG_SETDEPTH;
-  buf[18] = 4;
-  buf[19] = 4;
-  buf[20] = 32;
-
-  buf[21] = mailbox::MBOX_TAG_SETPXLORDR;
-  buf[22] = 4;
-  buf[23] = 4;
-  buf[24] = 1;
-
-  buf[25] = mailbox::MBOX_TAG_GETFB;
-  buf[26] = 8;
-  buf[27] = 8;
-  buf[28] = 4096;
-  buf[29] = 0;
-
-  buf[30] = mailbox::MBOX_TAG_GETPITCH;
-  buf[31] = 4;
-  buf[32] = 4;
-  buf[33] = 0;
-
-  buf[34] = mailbox::MBOX_TAG_LAST;
-  buf[35] = 0;
+  *mailbox::get_buffer_mut() = FB_SETUP;
 }
@@ -0,0 +1,22 @@
+use crate::debug::profile;
+use crate::interrupts;
+use crate::task;
+
+/// @fn irq_exception() -> u32
+/// @brief   Handles an IRQ exception.
+/// @details Called from the IRQ vector on the core's IRQ stack with the slim
+///          frame saved and interrupts masked. Handlers must not context
+///          switch from here; ones that want to reschedule set the flag this
+///          returns, and the vector preempts from the task's own stack.
+/// @returns 1 if the vector should preempt the interrupted task, else 0.
+#[link_section = ".text.hot"]
+#[no_mangle]
+pub extern "C" fn irq_exception() -> u32 {
+  crate::trace!(crate::debug::trace::EVT_IRQ_ENTRY);
+
+  let scope = profile::Scope::enter(profile::STAT_IRQ_DISPATCH);
+  interrupts::dispatch();
+  drop(scope);
+
+  task::take_need_resched() as u32
+}
@@ -1 +1,2 @@
+pub mod irq;
 pub mod trap;
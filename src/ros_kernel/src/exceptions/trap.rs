@@ -1,14 +1,184 @@
 use crate::dbg_print;
+use crate::debug::log;
+use crate::task;
 
-/// @fn trap_exception(esr_el1: usize, far_el1: usize)
-/// @brief Handles an exception trap.
+/// @var ESR_EC_SHIFT
+/// @brief Shift of the exception class field in ESR_EL1.
+const ESR_EC_SHIFT: usize = 26;
+
+/// @var ESR_ISS_FSC
+/// @brief Fault status code mask in an abort's syndrome.
+const ESR_ISS_FSC: usize = 0x3f;
+
+/// @var EC_COUNT
+/// @brief The exception class field is 6 bits wide.
+const EC_COUNT: usize = 64;
+
+pub const EC_FP_ACCESS: usize = 0x07;
+pub const EC_SVC64: usize = 0x15;
+pub const EC_INSN_ABORT_LOWER: usize = 0x20;
+pub const EC_INSN_ABORT: usize = 0x21;
+pub const EC_PC_ALIGN: usize = 0x22;
+pub const EC_DATA_ABORT_LOWER: usize = 0x24;
+pub const EC_DATA_ABORT: usize = 0x25;
+pub const EC_SP_ALIGN: usize = 0x26;
+
+/// @typedef TrapHandler
+/// @brief   A synchronous exception class handler.
+/// @details Receives the raw syndrome and fault address; returns true if the
+///          fault is resolved and the faulting context should resume.
+pub type TrapHandler = fn(esr: usize, far: usize) -> bool;
+
+/// @var TRAP_HANDLERS
+/// @brief   The trap dispatch table, indexed by exception class.
+/// @details A direct indexed dispatch rather than a cascading match, so the
+///          fault paths that demand paging will lean on stay O(1). The kernel
+///          is single-threaded, so directly accessing the table is safe.
+static mut TRAP_HANDLERS: [TrapHandler; EC_COUNT] = {
+  let mut handlers: [TrapHandler; EC_COUNT] = [unknown_trap; EC_COUNT];
+  handlers[EC_FP_ACCESS] = task::fp_trap;
+  handlers[EC_INSN_ABORT_LOWER] = insn_abort_trap;
+  handlers[EC_INSN_ABORT] = insn_abort_trap;
+  handlers[EC_PC_ALIGN] = align_trap;
+  handlers[EC_DATA_ABORT_LOWER] = data_abort_trap;
+  handlers[EC_DATA_ABORT] = data_abort_trap;
+  handlers[EC_SP_ALIGN] = align_trap;
+  handlers
+};
+
+/// @fn register_trap_handler(ec: usize, handler: TrapHandler)
+/// @brief   Register a subsystem's handler for an exception class.
+/// @details Replaces the default handler; the memory manager will hang
+///          demand paging off the abort classes this way.
+/// @param[in] ec      The exception class.
+/// @param[in] handler The handler.
+pub fn register_trap_handler(ec: usize, handler: TrapHandler) {
+  assert!(ec < EC_COUNT);
+
+  unsafe {
+    TRAP_HANDLERS[ec] = handler;
+  }
+}
+
+/// @fn trap_exception(esr_el1: usize, far_el1: usize) -> u32
+/// @brief   Dispatch a synchronous exception.
+/// @details Called from the exception vector with a full frame saved. The
+///          exception class indexes the handler table; an unresolved fault
+///          pushes the log out to the UART before the vector halts.
 /// @param[in] esr_el1 Exception Syndrome Register.
 /// @param[in] far_el1 Fault Address Register.
+/// @returns 1 if the vector should restore the frame and resume, else 0.
 #[no_mangle]
-pub extern "C" fn trap_exception(esr_el1: usize, far_el1: usize) {
+pub extern "C" fn trap_exception(esr_el1: usize, far_el1: usize) -> u32 {
+  crate::trace!(crate::debug::trace::EVT_TRAP_ENTRY, esr_el1);
+
+  let ec = (esr_el1 >> ESR_EC_SHIFT) & (EC_COUNT - 1);
+  let handled = unsafe { TRAP_HANDLERS[ec] }(esr_el1, far_el1);
+
+  if !handled {
+    // The faulting context never resumes and interrupts stay masked, so the
+    // ring has to go straight out the wire.
+    log::drain_blocking();
+  }
+
+  handled as u32
+}
+
+/// @fn unknown_trap(esr: usize, far: usize) -> bool
+/// @brief   Default handler for unregistered exception classes.
+/// @returns Always false.
+fn unknown_trap(esr: usize, far: usize) -> bool {
+  dbg_print!("Unhandled trap: esr={:#x}, far={:#x}\n", esr, far);
+  false
+}
+
+/// @fn data_abort_trap(esr: usize, far: usize) -> bool
+/// @brief   Default data abort handler.
+/// @details Placeholder until the memory manager registers a page fault
+///          handler.
+/// @returns Always false.
+fn data_abort_trap(esr: usize, far: usize) -> bool {
+  dbg_print!(
+    "Data abort: addr={:#x}, fsc={:#x}, esr={:#x}\n",
+    far,
+    esr & ESR_ISS_FSC,
+    esr
+  );
+  false
+}
+
+/// @fn insn_abort_trap(esr: usize, far: usize) -> bool
+/// @brief   Default instruction abort handler.
+/// @returns Always false.
+fn insn_abort_trap(esr: usize, far: usize) -> bool {
   dbg_print!(
-    "Fell into a trap! esr_el1={:#x}, far_el1={:#x}\n",
-    esr_el1,
-    far_el1
+    "Instruction abort: addr={:#x}, fsc={:#x}, esr={:#x}\n",
+    far,
+    esr & ESR_ISS_FSC,
+    esr
   );
+  false
+}
+
+/// @fn align_trap(esr: usize, far: usize) -> bool
+/// @brief   Default PC/SP alignment fault handler.
+/// @returns Always false.
+fn align_trap(esr: usize, far: usize) -> bool {
+  dbg_print!("Alignment fault: esr={:#x}, far={:#x}\n", esr, far);
+  false
+}
+
+/// @typedef Syscall
+/// @brief A syscall table entry; three raw arguments in, one result out.
+type Syscall = fn(usize, usize, usize) -> usize;
+
+/// @var SYSCALL_TABLE
+/// @brief The syscall table, indexed by the shared syscall numbers.
+const SYSCALL_TABLE: [Syscall; ros_kernel_user::SYS_COUNT] = [sys_write, sys_yield, sys_exit];
+
+/// @fn handle_syscall(arg0: usize, arg1: usize, arg2: usize, num: usize) -> usize
+/// @brief   Dispatch a syscall.
+/// @details Called from the EL0 SVC fast path with only the frame record and
+///          return state stacked; everything else rides on the procedure call
+///          standard.
+/// @param[in] arg0 The first argument.
+/// @param[in] arg1 The second argument.
+/// @param[in] arg2 The third argument.
+/// @param[in] num  The syscall number.
+/// @returns The syscall's result, or SYS_ENOSYS for a bad number.
+#[no_mangle]
+pub extern "C" fn handle_syscall(arg0: usize, arg1: usize, arg2: usize, num: usize) -> usize {
+  if num >= ros_kernel_user::SYS_COUNT {
+    return ros_kernel_user::SYS_ENOSYS;
+  }
+
+  SYSCALL_TABLE[num](arg0, arg1, arg2)
+}
+
+/// @fn sys_write(ptr: usize, len: usize, _: usize) -> usize
+/// @brief   Write caller bytes to the kernel log.
+/// @details The caller's buffer is read in place; tasks share the kernel's
+///          flat address space.
+/// @param[in] ptr The buffer address.
+/// @param[in] len The buffer length.
+/// @returns The number of bytes written.
+fn sys_write(ptr: usize, len: usize, _: usize) -> usize {
+  let bytes = unsafe { core::slice::from_raw_parts(ptr as *const u8, len) };
+  log::write_bytes(bytes);
+  len
+}
+
+/// @fn sys_yield(_: usize, _: usize, _: usize) -> usize
+/// @brief   Give up the CPU to the next runnable task.
+/// @returns Always 0.
+fn sys_yield(_: usize, _: usize, _: usize) -> usize {
+  task::schedule();
+  0
+}
+
+/// @fn sys_exit(_: usize, _: usize, _: usize) -> usize
+/// @brief   Retire the calling task.
+/// @returns Does not return.
+fn sys_exit(_: usize, _: usize, _: usize) -> usize {
+  task::task_exit();
 }
@@ -0,0 +1,114 @@
+use super::{IRQ_AUX, IRQ_DMA, IRQ_MAILBOX, IRQ_TIMER};
+use crate::peripherals::base;
+use crate::smp;
+use core::ptr;
+
+/// @var LOCAL_BASE
+/// @brief   Base address of the BCM2836 core-local register block.
+/// @details Unlike the BCM2835 peripherals, the local block has a fixed
+///          address outside the peripheral window.
+const LOCAL_BASE: usize = 0x40000000;
+
+/// @var CORE_TIMER_IRQCNTL
+/// @brief Per-core timer interrupt routing registers, 4 bytes per core.
+const CORE_TIMER_IRQCNTL: usize = LOCAL_BASE + 0x40;
+
+/// @var CORE_IRQ_SOURCE
+/// @brief Per-core pending interrupt source registers, 4 bytes per core.
+const CORE_IRQ_SOURCE: usize = LOCAL_BASE + 0x60;
+
+/// @var SOURCE_CNTPNS
+/// @brief Core interrupt source bit for the non-secure physical timer.
+const SOURCE_CNTPNS: u32 = 0x1 << 1;
+
+/// @var SOURCE_GPU
+/// @brief Core interrupt source bit for the chained BCM2835 controller.
+const SOURCE_GPU: u32 = 0x1 << 8;
+
+// BCM2835 interrupt controller registers, relative to the peripheral base.
+const IRQ_BASIC_PENDING: usize = 0xb200;
+const IRQ_PENDING_1: usize = 0xb204;
+const IRQ_ENABLE_1: usize = 0xb210;
+const IRQ_ENABLE_BASIC: usize = 0xb218;
+
+/// @var PENDING_1_AUX
+/// @brief GPU IRQ 29, the AUX block.
+const PENDING_1_AUX: u32 = 0x1 << 29;
+
+/// @var PENDING_1_DMA0
+/// @brief GPU IRQ 16, DMA channel 0.
+const PENDING_1_DMA0: u32 = 0x1 << 16;
+
+/// @var BASIC_MAILBOX
+/// @brief Basic IRQ 1, the ARM mailbox.
+const BASIC_MAILBOX: u32 = 0x1 << 1;
+
+/// @fn init()
+/// @brief   Initialize the BCM2836 local interrupt controller.
+/// @details Routes the non-secure physical timer of every core to that
+///          core's IRQ line; the sources stay masked at the BCM2835
+///          controller until a handler is registered.
+pub fn init() {
+  for core in 0..smp::MAX_CORES {
+    local_reg_put(SOURCE_CNTPNS, CORE_TIMER_IRQCNTL + (core * 4));
+  }
+}
+
+/// @fn enable_irq(irq: usize)
+/// @brief   Unmask a logical IRQ source.
+/// @details The timer routing is set up by init; the remaining sources live
+///          behind the BCM2835 controller's enable registers.
+/// @param[in] irq The logical IRQ source.
+pub fn enable_irq(irq: usize) {
+  match irq {
+    IRQ_TIMER => {}
+    IRQ_AUX => base::peripheral_reg_put(PENDING_1_AUX, IRQ_ENABLE_1),
+    IRQ_DMA => base::peripheral_reg_put(PENDING_1_DMA0, IRQ_ENABLE_1),
+    IRQ_MAILBOX => base::peripheral_reg_put(BASIC_MAILBOX, IRQ_ENABLE_BASIC),
+    _ => {}
+  }
+}
+
+/// @fn dispatch()
+/// @brief Dispatch the interrupts pending for the executing core.
+pub fn dispatch() {
+  let source = local_reg_get(CORE_IRQ_SOURCE + (smp::core_id() * 4));
+
+  if (source & SOURCE_CNTPNS) != 0 {
+    super::run_handler(IRQ_TIMER);
+  }
+
+  if (source & SOURCE_GPU) != 0 {
+    let pending = base::peripheral_reg_get(IRQ_PENDING_1);
+
+    if (pending & PENDING_1_AUX) != 0 {
+      super::run_handler(IRQ_AUX);
+    }
+
+    if (pending & PENDING_1_DMA0) != 0 {
+      super::run_handler(IRQ_DMA);
+    }
+
+    if (base::peripheral_reg_get(IRQ_BASIC_PENDING) & BASIC_MAILBOX) != 0 {
+      super::run_handler(IRQ_MAILBOX);
+    }
+  }
+}
+
+/// @fn local_reg_put(val: u32, to: usize)
+/// @brief Write a 32-bit integer into a core-local register.
+/// @param[in] val Value to write.
+/// @param[in] to  Register to receive the value.
+fn local_reg_put(val: u32, to: usize) {
+  unsafe {
+    ptr::write_volatile(to as *mut u32, val);
+  }
+}
+
+/// @fn local_reg_get(from: usize) -> u32
+/// @brief   Read a 32-bit integer from a core-local register.
+/// @param[in] from Register to read.
+/// @returns The register's value.
+fn local_reg_get(from: usize) -> u32 {
+  unsafe { ptr::read_volatile(from as *const u32) }
+}
@@ -0,0 +1,118 @@
+use super::{IRQ_AUX, IRQ_COUNT, IRQ_DMA, IRQ_MAILBOX, IRQ_TIMER};
+use core::ptr;
+
+/// @var GICD_BASE
+/// @brief Base address of the GIC-400 distributor on the BCM2711.
+const GICD_BASE: usize = 0xff841000;
+
+/// @var GICC_BASE
+/// @brief Base address of the GIC-400 CPU interface on the BCM2711.
+const GICC_BASE: usize = 0xff842000;
+
+const GICD_CTLR: usize = GICD_BASE;
+const GICD_ISENABLER: usize = GICD_BASE + 0x100;
+const GICD_IPRIORITYR: usize = GICD_BASE + 0x400;
+const GICD_ITARGETSR: usize = GICD_BASE + 0x800;
+
+const GICC_CTLR: usize = GICC_BASE;
+const GICC_PMR: usize = GICC_BASE + 0x4;
+const GICC_IAR: usize = GICC_BASE + 0xc;
+const GICC_EOIR: usize = GICC_BASE + 0x10;
+
+/// @var IAR_ID_MASK
+/// @brief Interrupt ID bits of GICC_IAR.
+const IAR_ID_MASK: u32 = 0x3ff;
+
+/// @var ID_SPURIOUS
+/// @brief Lowest interrupt ID that signals a spurious acknowledge.
+const ID_SPURIOUS: u32 = 1022;
+
+/// @var IRQ_IDS
+/// @brief   GIC interrupt ID for each logical IRQ source.
+/// @details Indexed off the logical IRQ constants so the table stays correct
+///          if the logical ordering ever changes. The non-secure physical
+///          timer is PPI 30. The BCM2711 maps the VideoCore IRQs to SPI IDs
+///          96 + n (AUX is VC IRQ 29, DMA 0 is VC IRQ 16) and the ARM
+///          mailbox to ID 65.
+const IRQ_IDS: [u32; IRQ_COUNT] = {
+  let mut ids = [0; IRQ_COUNT];
+  ids[IRQ_TIMER] = 30;
+  ids[IRQ_AUX] = 125;
+  ids[IRQ_MAILBOX] = 65;
+  ids[IRQ_DMA] = 112;
+  ids
+};
+
+/// @fn init()
+/// @brief   Initialize the GIC-400.
+/// @details Enables the distributor and this core's CPU interface, and opens
+///          the priority mask; individual interrupts stay disabled until a
+///          handler is registered.
+pub fn init() {
+  reg_put(0x1, GICD_CTLR);
+  reg_put(0xff, GICC_PMR);
+  reg_put(0x1, GICC_CTLR);
+}
+
+/// @fn enable_irq(irq: usize)
+/// @brief   Unmask a logical IRQ source at the distributor.
+/// @details Sets a mid-range priority and targets core 0; the GIC-400 only
+///          delivers SPIs to cores listed in the target register.
+/// @param[in] irq The logical IRQ source.
+pub fn enable_irq(irq: usize) {
+  let id = IRQ_IDS[irq] as usize;
+
+  unsafe {
+    ptr::write_volatile((GICD_IPRIORITYR + id) as *mut u8, 0xa0);
+
+    if id >= 32 {
+      ptr::write_volatile((GICD_ITARGETSR + id) as *mut u8, 0x1);
+    }
+  }
+
+  reg_put(0x1 << (id & 0x1f), GICD_ISENABLER + ((id / 32) * 4));
+}
+
+/// @fn dispatch()
+/// @brief   Dispatch the interrupts pending for the executing core.
+/// @details Acknowledges interrupts from the CPU interface until it returns
+///          a spurious ID. Each interrupt is completed before its handler
+///          runs: IRQs stay masked at the CPU regardless, and a handler that
+///          context-switches away must not leave the interrupt active.
+pub fn dispatch() {
+  loop {
+    let iar = reg_get(GICC_IAR);
+    let id = iar & IAR_ID_MASK;
+
+    if id >= ID_SPURIOUS {
+      break;
+    }
+
+    reg_put(iar, GICC_EOIR);
+
+    for irq in 0..IRQ_COUNT {
+      if IRQ_IDS[irq] == id {
+        super::run_handler(irq);
+        break;
+      }
+    }
+  }
+}
+
+/// @fn reg_put(val: u32, to: usize)
+/// @brief Write a 32-bit integer into a GIC register.
+/// @param[in] val Value to write.
+/// @param[in] to  Register to receive the value.
+fn reg_put(val: u32, to: usize) {
+  unsafe {
+    ptr::write_volatile(to as *mut u32, val);
+  }
+}
+
+/// @fn reg_get(from: usize) -> u32
+/// @brief   Read a 32-bit integer from a GIC register.
+/// @param[in] from Register to read.
+/// @returns The register's value.
+fn reg_get(from: usize) -> u32 {
+  unsafe { ptr::read_volatile(from as *const u32) }
+}
@@ -0,0 +1,114 @@
+mod bcm2836;
+mod gic400;
+
+/// @var IRQ_TIMER
+/// @brief Logical IRQ source for the core-local generic timer.
+pub const IRQ_TIMER: usize = 0;
+
+/// @var IRQ_AUX
+/// @brief Logical IRQ source for the AUX block (mini UART).
+pub const IRQ_AUX: usize = 1;
+
+/// @var IRQ_MAILBOX
+/// @brief Logical IRQ source for the VideoCore mailbox.
+pub const IRQ_MAILBOX: usize = 2;
+
+/// @var IRQ_DMA
+/// @brief Logical IRQ source for DMA channel 0.
+pub const IRQ_DMA: usize = 3;
+
+/// @var IRQ_COUNT
+/// @brief Number of logical IRQ sources.
+pub const IRQ_COUNT: usize = 4;
+
+/// @var PI4_PERIPHERAL_BASE
+/// @brief The Pi 4 peripheral base address; it identifies the board as
+///        having a GIC-400 rather than the legacy interrupt controller.
+const PI4_PERIPHERAL_BASE: usize = 0xfe000000;
+
+/// @typedef IRQHandler
+/// @brief A per-source interrupt handler. Handlers run with interrupts
+///        masked and must not block.
+pub type IRQHandler = fn();
+
+/// @enum Controller
+/// @brief The interrupt controller present on the board.
+#[derive(Copy, Clone, PartialEq)]
+enum Controller {
+  None,
+  Bcm2836,
+  Gic400,
+}
+
+/// @var CONTROLLER
+/// @brief The active interrupt controller. The kernel is single-threaded, so
+///        directly accessing the value is safe.
+static mut CONTROLLER: Controller = Controller::None;
+
+/// @var HANDLERS
+/// @brief Registered handlers indexed by logical IRQ source.
+static mut HANDLERS: [Option<IRQHandler>; IRQ_COUNT] = [None; IRQ_COUNT];
+
+/// @fn init(peripheral_base: usize)
+/// @brief   Initialize the board's interrupt controller.
+/// @details The Pi 2 and Pi 3 use the BCM2836 local controller chained to
+///          the legacy BCM2835 controller; the Pi 4 uses a GIC-400. The
+///          peripheral base address distinguishes the two.
+/// @param[in] peripheral_base The peripheral base address.
+pub fn init(peripheral_base: usize) {
+  unsafe {
+    if peripheral_base == PI4_PERIPHERAL_BASE {
+      CONTROLLER = Controller::Gic400;
+      gic400::init();
+    } else {
+      CONTROLLER = Controller::Bcm2836;
+      bcm2836::init();
+    }
+  }
+}
+
+/// @fn register_irq(irq: usize, handler: IRQHandler)
+/// @brief   Register a handler for a logical IRQ source and unmask the
+///          source at the controller.
+/// @param[in] irq     The logical IRQ source.
+/// @param[in] handler The handler to run when the source raises an
+///                    interrupt.
+pub fn register_irq(irq: usize, handler: IRQHandler) {
+  assert!(irq < IRQ_COUNT);
+
+  unsafe {
+    HANDLERS[irq] = Some(handler);
+
+    match CONTROLLER {
+      Controller::Bcm2836 => bcm2836::enable_irq(irq),
+      Controller::Gic400 => gic400::enable_irq(irq),
+      Controller::None => {}
+    }
+  }
+}
+
+/// @fn dispatch()
+/// @brief   Dispatch the pending interrupts to their handlers.
+/// @details Called from the IRQ vector with interrupts masked.
+pub fn dispatch() {
+  unsafe {
+    match CONTROLLER {
+      Controller::Bcm2836 => bcm2836::dispatch(),
+      Controller::Gic400 => gic400::dispatch(),
+      Controller::None => {}
+    }
+  }
+}
+
+/// @fn run_handler(irq: usize)
+/// @brief   Run the handler registered for a logical IRQ source.
+/// @details Interrupts from sources without a handler are silently dropped;
+///          the controllers only unmask registered sources.
+/// @param[in] irq The logical IRQ source.
+fn run_handler(irq: usize) {
+  unsafe {
+    if let Some(handler) = HANDLERS[irq] {
+      handler();
+    }
+  }
+}
@@ -1,9 +1,18 @@
 #![no_std]
 
+extern crate alloc;
+
 mod arch;
+#[cfg(feature = "bench")]
+mod bench;
 mod debug;
 mod drivers;
 mod exceptions;
+mod interrupts;
+mod mm;
 mod peripherals;
 mod ros_kernel;
+mod smp;
 mod support;
+mod task;
+mod timer;
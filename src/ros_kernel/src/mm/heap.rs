@@ -0,0 +1,215 @@
+use super::page_allocator;
+use core::alloc::{GlobalAlloc, Layout};
+use core::ptr;
+
+/// @var SLAB_MIN_SIZE
+/// @brief Smallest slab object size; must hold a free list link.
+const SLAB_MIN_SIZE: usize = 16;
+
+/// @var SLAB_MAX_SIZE
+/// @brief Largest slab object size. Larger allocations go straight to the
+///        page frame allocator.
+const SLAB_MAX_SIZE: usize = 512;
+
+/// @var SLAB_CLASSES
+/// @brief Number of slab size classes: 16, 32, 64, 128, 256, and 512 bytes.
+const SLAB_CLASSES: usize = 6;
+
+/// @var SLAB_FREE_LISTS
+/// @brief   Free object list head per size class; 0 terminates a list.
+/// @details Free objects store the address of the next free object in their
+///          first bytes, so allocation and freeing on the hot path are a
+///          single list push or pop. The kernel is single-threaded, so
+///          directly accessing the lists is safe.
+static mut SLAB_FREE_LISTS: [usize; SLAB_CLASSES] = [0; SLAB_CLASSES];
+
+const EARLY_ARENA_SIZE: usize = 64 * 1024;
+
+/// @struct EarlyArena
+/// @brief   Bump arena for early-boot allocations.
+/// @details Serves allocations made before the page frame allocator has any
+///          memory, and init-time structures that are never freed. Page
+///          aligned so slab refills can carve page-sized chunks from it.
+#[repr(align(4096))]
+struct EarlyArena {
+  bytes: [u8; EARLY_ARENA_SIZE],
+}
+
+static mut EARLY_ARENA: EarlyArena = EarlyArena {
+  bytes: [0; EARLY_ARENA_SIZE],
+};
+
+static mut EARLY_ARENA_OFFS: usize = 0;
+
+/// @struct KernelHeap
+/// @brief   The kernel's global allocator.
+/// @details Small allocations come from per-size slab caches refilled a page
+///          at a time; larger allocations map directly onto page frame
+///          blocks. Freed slab objects go back on their class's free list,
+///          so the caches do not fragment the page allocator.
+pub struct KernelHeap;
+
+#[global_allocator]
+static ALLOCATOR: KernelHeap = KernelHeap;
+
+unsafe impl GlobalAlloc for KernelHeap {
+  unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+    match size_class(&layout) {
+      Some(class) => slab_alloc(class),
+      None => page_alloc(&layout),
+    }
+  }
+
+  unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+    let addr = ptr as usize;
+
+    // Early arena allocations are never reclaimed.
+    if arena_owns(addr) {
+      return;
+    }
+
+    match size_class(&layout) {
+      Some(class) => slab_free(class, addr),
+      None => page_allocator::free_pages(addr, page_order(&layout)),
+    }
+  }
+}
+
+/// @fn early_alloc(size: usize, align: usize) -> *mut u8
+/// @brief   Allocate never-freed memory from the early-boot bump arena.
+/// @param[in] size  The allocation size in bytes.
+/// @param[in] align The required alignment; must be a power of 2.
+/// @returns The allocation, or null if the arena is exhausted.
+pub fn early_alloc(size: usize, align: usize) -> *mut u8 {
+  unsafe {
+    let base = EARLY_ARENA.bytes.as_mut_ptr() as usize;
+    let addr = (base + EARLY_ARENA_OFFS + align - 1) & !(align - 1);
+
+    if addr + size > base + EARLY_ARENA_SIZE {
+      return ptr::null_mut();
+    }
+
+    EARLY_ARENA_OFFS = (addr + size) - base;
+
+    addr as *mut u8
+  }
+}
+
+/// @fn size_class(layout: &Layout) -> Option<usize>
+/// @brief   Pick the slab size class for a layout.
+/// @param[in] layout The allocation layout.
+/// @returns The class index, or None if the allocation is too big for the
+///          slabs.
+fn size_class(layout: &Layout) -> Option<usize> {
+  let size = layout
+    .size()
+    .max(layout.align())
+    .max(SLAB_MIN_SIZE)
+    .next_power_of_two();
+
+  if size > SLAB_MAX_SIZE {
+    return None;
+  }
+
+  Some((size.trailing_zeros() - SLAB_MIN_SIZE.trailing_zeros()) as usize)
+}
+
+/// @fn class_size(class: usize) -> usize
+/// @returns The object size of a slab class.
+fn class_size(class: usize) -> usize {
+  SLAB_MIN_SIZE << class
+}
+
+/// @fn slab_alloc(class: usize) -> *mut u8
+/// @brief   Pop an object from a slab cache, refilling it if necessary.
+/// @param[in] class The size class.
+/// @returns The object, or null if no memory is available.
+unsafe fn slab_alloc(class: usize) -> *mut u8 {
+  if SLAB_FREE_LISTS[class] == 0 {
+    slab_refill(class);
+  }
+
+  let addr = SLAB_FREE_LISTS[class];
+
+  if addr == 0 {
+    return ptr::null_mut();
+  }
+
+  SLAB_FREE_LISTS[class] = *(addr as *const usize);
+
+  addr as *mut u8
+}
+
+/// @fn slab_free(class: usize, addr: usize)
+/// @brief Push an object back onto its slab cache.
+/// @param[in] class The size class.
+/// @param[in] addr  The object address.
+unsafe fn slab_free(class: usize, addr: usize) {
+  *(addr as *mut usize) = SLAB_FREE_LISTS[class];
+  SLAB_FREE_LISTS[class] = addr;
+}
+
+/// @fn slab_refill(class: usize)
+/// @brief   Carve a fresh page into objects for a slab cache.
+/// @details Falls back to the early-boot arena when the page frame allocator
+///          has no memory yet.
+/// @param[in] class The size class.
+unsafe fn slab_refill(class: usize) {
+  let page = match page_allocator::alloc_page() {
+    Some(addr) => addr,
+    None => {
+      let addr = early_alloc(page_allocator::PAGE_SIZE, page_allocator::PAGE_SIZE);
+      if addr.is_null() {
+        return;
+      }
+      addr as usize
+    }
+  };
+
+  let size = class_size(class);
+  let mut addr = page;
+
+  while addr + size <= page + page_allocator::PAGE_SIZE {
+    slab_free(class, addr);
+    addr += size;
+  }
+}
+
+/// @fn page_alloc(layout: &Layout) -> *mut u8
+/// @brief   Allocate whole page frame blocks for a large layout.
+/// @param[in] layout The allocation layout.
+/// @returns The allocation, or null if no block is available.
+unsafe fn page_alloc(layout: &Layout) -> *mut u8 {
+  let order = page_order(layout);
+
+  if order > page_allocator::MAX_ORDER {
+    return ptr::null_mut();
+  }
+
+  match page_allocator::alloc_pages(order) {
+    Some(addr) => addr as *mut u8,
+    None => ptr::null_mut(),
+  }
+}
+
+/// @fn page_order(layout: &Layout) -> usize
+/// @brief   Compute the page block order for a large layout.
+/// @details Blocks are naturally aligned, so any alignment up to the block
+///          size is satisfied automatically.
+/// @param[in] layout The allocation layout.
+/// @returns The block order.
+fn page_order(layout: &Layout) -> usize {
+  let size = layout.size().max(layout.align());
+  let pages = (size + page_allocator::PAGE_SIZE - 1) / page_allocator::PAGE_SIZE;
+
+  pages.next_power_of_two().trailing_zeros() as usize
+}
+
+/// @fn arena_owns(addr: usize) -> bool
+/// @param[in] addr The allocation address.
+/// @returns True if the address came from the early-boot arena.
+fn arena_owns(addr: usize) -> bool {
+  let base = unsafe { EARLY_ARENA.bytes.as_ptr() as usize };
+
+  addr >= base && addr < base + EARLY_ARENA_SIZE
+}
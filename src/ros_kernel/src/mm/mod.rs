@@ -0,0 +1,2 @@
+pub mod heap;
+pub mod page_allocator;
@@ -0,0 +1,224 @@
+use crate::support::kernel_init::ROSMemoryRegion;
+
+/// @var PAGE_SIZE
+/// @brief Size of a physical page frame in bytes.
+pub const PAGE_SIZE: usize = 4096;
+
+const PAGE_SHIFT: usize = 12;
+
+/// @var MAX_ORDER
+/// @brief Largest block order. Order 10 blocks are 4 MiB.
+pub const MAX_ORDER: usize = 10;
+
+/// @var MAX_PAGES
+/// @brief Number of page frames tracked; 4 GiB of 4 KiB pages covers every
+///        supported board.
+const MAX_PAGES: usize = 0x100000;
+
+const META_FREE: u8 = 0x80;
+const META_ORDER_MASK: u8 = 0x7f;
+
+/// @struct FreeBlock
+/// @brief   Intrusive free list node stored in the first bytes of a free
+///          block.
+/// @details The links are physical addresses with 0 acting as the list
+///          terminator; address 0 is never handed to the allocator because
+///          the kernel image reservation covers it.
+/// @var prev Physical address of the previous free block of the same order.
+/// @var next Physical address of the next free block of the same order.
+struct FreeBlock {
+  prev: usize,
+  next: usize,
+}
+
+/// @var FREE_LISTS
+/// @brief Head of the free block list for each order. The kernel is
+///        single-threaded, so directly accessing the lists is safe.
+static mut FREE_LISTS: [usize; MAX_ORDER + 1] = [0; MAX_ORDER + 1];
+
+/// @var PAGE_META
+/// @brief   Per-page state: META_FREE plus the order of the block the page
+///          starts, or 0 for pages that are allocated or unknown.
+/// @details Only the first page of a block carries its order; the metadata
+///          lets free_pages find and merge buddies in constant time.
+static mut PAGE_META: [u8; MAX_PAGES] = [0; MAX_PAGES];
+
+/// @var FREE_PAGE_COUNT
+/// @brief Number of page frames currently on the free lists.
+static mut FREE_PAGE_COUNT: usize = 0;
+
+extern "C" {
+  static __end: u8;
+}
+
+/// @fn init(regions: &[ROSMemoryRegion])
+/// @brief   Seed the allocator from the bootloader-provided memory regions.
+/// @details Everything below the end of the kernel image stays reserved; that
+///          range also covers the boot stacks and the firmware spin table.
+/// @param[in] regions The memory regions; entries with a zero size are
+///                    ignored.
+pub fn init(regions: &[ROSMemoryRegion]) {
+  let kernel_end = unsafe { (&__end as *const u8 as usize + PAGE_SIZE - 1) & !(PAGE_SIZE - 1) };
+
+  for rgn in regions {
+    if rgn.size == 0 {
+      continue;
+    }
+
+    let mut addr = (rgn.base + PAGE_SIZE - 1) & !(PAGE_SIZE - 1);
+    let end = (rgn.base + rgn.size) & !(PAGE_SIZE - 1);
+
+    if addr < kernel_end {
+      addr = kernel_end;
+    }
+
+    // Free the region as the largest naturally-aligned blocks that fit.
+    while addr < end {
+      let mut order = MAX_ORDER;
+
+      while order > 0 && ((addr & (block_size(order) - 1)) != 0 || addr + block_size(order) > end) {
+        order -= 1;
+      }
+
+      free_pages(addr, order);
+      addr += block_size(order);
+    }
+  }
+}
+
+/// @fn alloc_pages(order: usize) -> Option<usize>
+/// @brief   Allocate a naturally-aligned block of 2^order page frames.
+/// @details Takes the smallest free block that fits and splits it down,
+///          pushing the unused halves back on the free lists, so allocation
+///          is O(log n) in the block orders.
+/// @param[in] order The block order.
+/// @returns The physical address of the block, or None if no block is
+///          available.
+pub fn alloc_pages(order: usize) -> Option<usize> {
+  assert!(order <= MAX_ORDER);
+
+  unsafe {
+    let mut avail = order;
+
+    while avail <= MAX_ORDER && FREE_LISTS[avail] == 0 {
+      avail += 1;
+    }
+
+    if avail > MAX_ORDER {
+      return None;
+    }
+
+    let addr = FREE_LISTS[avail];
+    remove_block(avail, addr);
+
+    // Split the block down to the requested order.
+    while avail > order {
+      avail -= 1;
+      push_block(avail, addr + block_size(avail));
+    }
+
+    PAGE_META[addr >> PAGE_SHIFT] = order as u8;
+    FREE_PAGE_COUNT -= 1 << order;
+
+    Some(addr)
+  }
+}
+
+/// @fn alloc_page() -> Option<usize>
+/// @brief   Allocate a single page frame.
+/// @returns The physical address of the page, or None.
+pub fn alloc_page() -> Option<usize> {
+  alloc_pages(0)
+}
+
+/// @fn free_pages(addr: usize, order: usize)
+/// @brief   Free a block of 2^order page frames.
+/// @details Merges the block with its buddy repeatedly while the buddy is
+///          free and of the same order, so freeing is O(log n) in the block
+///          orders.
+/// @param[in] addr  The physical address of the block.
+/// @param[in] order The block order it was allocated with.
+pub fn free_pages(addr: usize, order: usize) {
+  assert!(order <= MAX_ORDER);
+  assert!(addr & (block_size(order) - 1) == 0);
+
+  let pages = 1 << order;
+  let mut addr = addr;
+  let mut order = order;
+
+  unsafe {
+    while order < MAX_ORDER {
+      let buddy = addr ^ block_size(order);
+      let buddy_page = buddy >> PAGE_SHIFT;
+
+      if buddy_page >= MAX_PAGES || PAGE_META[buddy_page] != (META_FREE | order as u8) {
+        break;
+      }
+
+      remove_block(order, buddy);
+      PAGE_META[buddy_page] = 0;
+      PAGE_META[addr >> PAGE_SHIFT] = 0;
+
+      addr &= !block_size(order);
+      order += 1;
+    }
+
+    push_block(order, addr);
+    FREE_PAGE_COUNT += pages;
+  }
+}
+
+/// @fn free_page(addr: usize)
+/// @brief Free a single page frame.
+/// @param[in] addr The physical address of the page.
+pub fn _free_page(addr: usize) {
+  free_pages(addr, 0)
+}
+
+/// @fn free_page_count() -> usize
+/// @brief   Get the number of page frames on the free lists.
+/// @returns The free page frame count.
+pub fn free_page_count() -> usize {
+  unsafe { FREE_PAGE_COUNT }
+}
+
+/// @fn block_size(order: usize) -> usize
+/// @returns The size in bytes of a block of the given order.
+fn block_size(order: usize) -> usize {
+  PAGE_SIZE << order
+}
+
+/// @fn push_block(order: usize, addr: usize)
+/// @brief Add a block to the head of its order's free list and mark it free.
+unsafe fn push_block(order: usize, addr: usize) {
+  let head = FREE_LISTS[order];
+  let blk = addr as *mut FreeBlock;
+
+  (*blk).prev = 0;
+  (*blk).next = head;
+
+  if head != 0 {
+    (*(head as *mut FreeBlock)).prev = addr;
+  }
+
+  FREE_LISTS[order] = addr;
+  PAGE_META[addr >> PAGE_SHIFT] = META_FREE | (order as u8 & META_ORDER_MASK);
+}
+
+/// @fn remove_block(order: usize, addr: usize)
+/// @brief Unlink a block from its order's free list.
+unsafe fn remove_block(order: usize, addr: usize) {
+  let blk = addr as *mut FreeBlock;
+  let prev = (*blk).prev;
+  let next = (*blk).next;
+
+  if prev != 0 {
+    (*(prev as *mut FreeBlock)).next = next;
+  } else {
+    FREE_LISTS[order] = next;
+  }
+
+  if next != 0 {
+    (*(next as *mut FreeBlock)).prev = prev;
+  }
+}
@@ -44,13 +44,3 @@ pub fn peripheral_reg_get(from: usize) -> u32 {
   let addr = get_peripheral_register_addr(from);
   unsafe { ptr::read_volatile(addr) }
 }
-
-/// @fn peripheral_delay(count: u64)
-/// @brief Runs a delay loop.
-/// @param[in] count Number of loop iterations.
-pub fn peripheral_delay(count: u64) {
-  let mut c = count;
-  while c > 0 {
-    c -= 1;
-  }
-}
@@ -0,0 +1,352 @@
+use super::base;
+use crate::arch;
+use crate::task;
+
+/// @var DMA_BASE
+/// @brief DMA controller registers relative to the peripheral base. Channel n
+///        occupies a 0x100-byte window at DMA_BASE + n * 0x100.
+const DMA_BASE: usize = 0x7000;
+
+const DMA_CHANNEL_WINDOW: usize = 0x100;
+
+const DMA_CS: usize = 0x00;
+const DMA_CONBLK_AD: usize = 0x04;
+const _DMA_DEBUG: usize = 0x20;
+
+/// @var DMA_ENABLE
+/// @brief Global channel enable register at the end of the DMA window.
+const DMA_ENABLE: usize = DMA_BASE + 0xff0;
+
+const DMA_CS_ACTIVE: u32 = 0x1 << 0;
+const DMA_CS_END: u32 = 0x1 << 1;
+const DMA_CS_INT: u32 = 0x1 << 2;
+const DMA_CS_ERROR: u32 = 0x1 << 8;
+const DMA_CS_RESET: u32 = 0x1 << 31;
+
+const DMA_TI_INTEN: u32 = 0x1 << 0;
+const DMA_TI_WAIT_RESP: u32 = 0x1 << 3;
+const DMA_TI_DEST_INC: u32 = 0x1 << 4;
+const DMA_TI_SRC_INC: u32 = 0x1 << 8;
+
+/// @var CHANNEL
+/// @brief   The DMA channel the kernel claims.
+/// @details Channel 0's interrupt is the one the interrupt controllers route
+///          as IRQ_DMA, and the firmware leaves it free. Transfers on the one
+///          channel are serialized through the control block queue.
+const CHANNEL: usize = 0;
+
+/// @fn channel_reg(reg: usize) -> usize
+/// @brief   Get a claimed-channel register address.
+/// @param[in] reg The register offset within the channel window.
+/// @returns The register address relative to the peripheral base.
+fn channel_reg(reg: usize) -> usize {
+  DMA_BASE + (CHANNEL * DMA_CHANNEL_WINDOW) + reg
+}
+
+/// @struct ControlBlock
+/// @brief   A DMA control block in the layout the engine scans.
+/// @details Must be 32-byte aligned. The engine ignores the last two words;
+///          fill transfers park the fill value in the first of them and point
+///          source_ad at it with source increment off.
+/// @var ti         Transfer information.
+/// @var source_ad  Source bus address.
+/// @var dest_ad    Destination bus address.
+/// @var txfr_len   Transfer length in bytes.
+/// @var stride     2D stride; unused by linear transfers.
+/// @var next_conbk Next control block bus address, or 0 to stop.
+/// @var fill       The fill value for fill transfers.
+#[repr(C, align(32))]
+struct ControlBlock {
+  ti: u32,
+  source_ad: u32,
+  dest_ad: u32,
+  txfr_len: u32,
+  stride: u32,
+  next_conbk: u32,
+  fill: u32,
+  _reserved: u32,
+}
+
+const EMPTY_BLOCK: ControlBlock = ControlBlock {
+  ti: 0,
+  source_ad: 0,
+  dest_ad: 0,
+  txfr_len: 0,
+  stride: 0,
+  next_conbk: 0,
+  fill: 0,
+  _reserved: 0,
+};
+
+/// @var POOL_SIZE
+/// @brief Number of control blocks in the pool.
+const POOL_SIZE: usize = 8;
+
+/// @enum BlockState
+/// @brief The state of a pool control block.
+#[derive(Copy, Clone, PartialEq)]
+enum BlockState {
+  /// Available for allocation.
+  Free,
+  /// Queued or on the engine.
+  Pending,
+  /// Transfer finished; the owner may free it.
+  Complete,
+}
+
+/// @typedef Callback
+/// @brief A completion callback. Runs from the DMA interrupt with the
+///        completed transfer's handle; it must not block.
+pub type Callback = fn(usize);
+
+/// @var POOL
+/// @brief   The control block pool and its bookkeeping.
+/// @details fill and copy mask interrupts around the bookkeeping they share
+///          with handle_interrupt; everything else only runs in task context.
+static mut POOL: [ControlBlock; POOL_SIZE] = [EMPTY_BLOCK; POOL_SIZE];
+
+static mut POOL_STATE: [BlockState; POOL_SIZE] = [BlockState::Free; POOL_SIZE];
+
+static mut CALLBACKS: [Option<Callback>; POOL_SIZE] = [None; POOL_SIZE];
+
+/// @var SUBMIT_QUEUE
+/// @brief FIFO of handles waiting for the channel, drained by the interrupt
+///        handler as transfers complete.
+static mut SUBMIT_QUEUE: [usize; POOL_SIZE] = [0; POOL_SIZE];
+
+static mut SUBMIT_HEAD: usize = 0;
+
+static mut SUBMIT_COUNT: usize = 0;
+
+/// @var ACTIVE
+/// @brief The handle on the engine, or None when the channel is idle.
+static mut ACTIVE: Option<usize> = None;
+
+/// @var ENABLED
+/// @brief True once init has claimed and reset the channel.
+static mut ENABLED: bool = false;
+
+/// @fn init()
+/// @brief   Claim and reset the kernel's DMA channel.
+/// @details The caller is responsible for routing the channel's interrupt to
+///          handle_interrupt at the interrupt controller.
+pub fn init() {
+  let enable = base::peripheral_reg_get(DMA_ENABLE);
+  base::peripheral_reg_put(enable | (0x1 << CHANNEL), DMA_ENABLE);
+
+  base::peripheral_reg_put(DMA_CS_RESET, channel_reg(DMA_CS));
+  while (base::peripheral_reg_get(channel_reg(DMA_CS)) & DMA_CS_RESET) != 0 {}
+
+  unsafe {
+    ENABLED = true;
+  }
+}
+
+/// @fn fill(dst: usize, value: u32, size: usize, callback: Option<Callback>) -> Option<usize>
+/// @brief   Fill a buffer with a 32-bit value using the DMA engine.
+/// @details Returns immediately; completion arrives via the DMA interrupt.
+///          The destination must not be touched until the transfer completes.
+/// @param[in] dst      The destination; must be word aligned.
+/// @param[in] value    The fill value.
+/// @param[in] size     The size in bytes; must be a multiple of 4.
+/// @param[in] callback An optional completion callback; without one the owner
+///                     polls with is_complete or blocks in wait.
+/// @returns A handle for the transfer, or None if DMA is unavailable or the
+///          pool is exhausted.
+pub fn fill(dst: usize, value: u32, size: usize, callback: Option<Callback>) -> Option<usize> {
+  assert!(dst % 4 == 0);
+  assert!(size % 4 == 0);
+
+  let handle = alloc_block()?;
+
+  unsafe {
+    let block = &mut POOL[handle];
+    block.ti = DMA_TI_INTEN | DMA_TI_WAIT_RESP | DMA_TI_DEST_INC;
+    block.fill = value;
+    block.source_ad = bus_address(&block.fill as *const u32 as usize);
+    block.dest_ad = bus_address(dst);
+    block.txfr_len = size as u32;
+    block.stride = 0;
+    block.next_conbk = 0;
+  }
+
+  // The engine writes RAM directly, so the destination cannot have dirty or
+  // stale lines in the data cache.
+  arch::cpu::flush_dcache_range(dst, size);
+
+  submit(handle, callback);
+
+  Some(handle)
+}
+
+/// @fn copy(dst: usize, src: usize, size: usize, callback: Option<Callback>) -> Option<usize>
+/// @brief   Copy a buffer using the DMA engine.
+/// @details Returns immediately; completion arrives via the DMA interrupt.
+///          The regions must not overlap and must not be touched until the
+///          transfer completes.
+/// @param[in] dst      The destination.
+/// @param[in] src      The source.
+/// @param[in] size     The size in bytes.
+/// @param[in] callback An optional completion callback; without one the owner
+///                     polls with is_complete or blocks in wait.
+/// @returns A handle for the transfer, or None if DMA is unavailable or the
+///          pool is exhausted.
+pub fn copy(dst: usize, src: usize, size: usize, callback: Option<Callback>) -> Option<usize> {
+  let handle = alloc_block()?;
+
+  unsafe {
+    let block = &mut POOL[handle];
+    block.ti = DMA_TI_INTEN | DMA_TI_WAIT_RESP | DMA_TI_DEST_INC | DMA_TI_SRC_INC;
+    block.source_ad = bus_address(src);
+    block.dest_ad = bus_address(dst);
+    block.txfr_len = size as u32;
+    block.stride = 0;
+    block.next_conbk = 0;
+  }
+
+  // The engine reads and writes RAM directly; push the source out of the
+  // data cache and drop the destination from it.
+  arch::cpu::clean_dcache_range(src, size);
+  arch::cpu::flush_dcache_range(dst, size);
+
+  submit(handle, callback);
+
+  Some(handle)
+}
+
+/// @fn is_complete(handle: usize) -> bool
+/// @brief   Poll a transfer for completion.
+/// @param[in] handle The transfer's handle.
+/// @returns True once the transfer has finished.
+pub fn is_complete(handle: usize) -> bool {
+  assert!(handle < POOL_SIZE);
+  unsafe { POOL_STATE[handle] == BlockState::Complete }
+}
+
+/// @fn free(handle: usize)
+/// @brief   Return a completed transfer's control block to the pool.
+/// @param[in] handle The transfer's handle.
+pub fn free(handle: usize) {
+  assert!(handle < POOL_SIZE);
+
+  unsafe {
+    assert!(POOL_STATE[handle] != BlockState::Pending);
+    POOL_STATE[handle] = BlockState::Free;
+  }
+}
+
+/// @fn wait(handle: usize)
+/// @brief   Block until a transfer completes, then free it.
+/// @details Yields to other tasks while the engine works.
+/// @param[in] handle The transfer's handle.
+pub fn wait(handle: usize) {
+  while !is_complete(handle) {
+    task::schedule();
+  }
+
+  free(handle);
+}
+
+/// @fn handle_interrupt()
+/// @brief   Service a DMA channel interrupt.
+/// @details Acknowledges the channel, completes the active transfer and runs
+///          its callback, then starts the next queued transfer.
+pub fn handle_interrupt() {
+  let status = base::peripheral_reg_get(channel_reg(DMA_CS));
+  base::peripheral_reg_put(status | DMA_CS_INT | DMA_CS_END, channel_reg(DMA_CS));
+
+  unsafe {
+    if let Some(handle) = ACTIVE {
+      ACTIVE = None;
+      POOL_STATE[handle] = BlockState::Complete;
+
+      if let Some(callback) = CALLBACKS[handle] {
+        callback(handle);
+      }
+    }
+
+    if (status & DMA_CS_ERROR) != 0 {
+      base::peripheral_reg_put(DMA_CS_RESET, channel_reg(DMA_CS));
+    }
+
+    if SUBMIT_COUNT > 0 {
+      let handle = SUBMIT_QUEUE[SUBMIT_HEAD];
+      SUBMIT_HEAD = (SUBMIT_HEAD + 1) % POOL_SIZE;
+      SUBMIT_COUNT -= 1;
+      start(handle);
+    }
+  }
+}
+
+/// @fn alloc_block() -> Option<usize>
+/// @brief   Allocate a control block from the pool.
+/// @returns A handle for the block, or None if DMA is unavailable or the pool
+///          is exhausted.
+fn alloc_block() -> Option<usize> {
+  unsafe {
+    if !ENABLED {
+      return None;
+    }
+
+    for handle in 0..POOL_SIZE {
+      if POOL_STATE[handle] == BlockState::Free {
+        POOL_STATE[handle] = BlockState::Pending;
+        return Some(handle);
+      }
+    }
+  }
+
+  None
+}
+
+/// @fn submit(handle: usize, callback: Option<Callback>)
+/// @brief   Hand a filled control block to the engine, or queue it.
+/// @param[in] handle   The transfer's handle.
+/// @param[in] callback An optional completion callback.
+fn submit(handle: usize, callback: Option<Callback>) {
+  unsafe {
+    // The control block must be in RAM before the engine scans it.
+    let block = &POOL[handle] as *const ControlBlock as usize;
+    arch::cpu::clean_dcache_range(block, core::mem::size_of::<ControlBlock>());
+
+    // The interrupt handler also starts transfers and pops the queue.
+    let state = arch::cpu::save_and_disable_interrupts();
+
+    CALLBACKS[handle] = callback;
+
+    if ACTIVE.is_none() {
+      start(handle);
+    } else {
+      SUBMIT_QUEUE[(SUBMIT_HEAD + SUBMIT_COUNT) % POOL_SIZE] = handle;
+      SUBMIT_COUNT += 1;
+    }
+
+    arch::cpu::restore_interrupts(state);
+  }
+}
+
+/// @fn start(handle: usize)
+/// @brief   Kick the engine with a control block.
+/// @details Must run with interrupts masked or from the interrupt handler.
+/// @param[in] handle The transfer's handle.
+fn start(handle: usize) {
+  unsafe {
+    ACTIVE = Some(handle);
+  }
+
+  let block = unsafe { &POOL[handle] as *const ControlBlock as usize };
+  base::peripheral_reg_put(bus_address(block), channel_reg(DMA_CONBLK_AD));
+  base::peripheral_reg_put(DMA_CS_ACTIVE | DMA_CS_INT | DMA_CS_END, channel_reg(DMA_CS));
+}
+
+/// @fn bus_address(addr: usize) -> u32
+/// @brief   Convert an ARM physical address to a DMA bus address.
+/// @details The legacy DMA engines see the first gigabyte of RAM through the
+///          0xC0000000 uncached alias, on the Pi 4 as well as the earlier
+///          boards. The kernel, its pools, and the framebuffer all live
+///          there.
+/// @param[in] addr The ARM physical address.
+/// @returns The 32-bit bus address.
+fn bus_address(addr: usize) -> u32 {
+  (addr as u32) | 0xc0000000
+}
@@ -118,7 +118,12 @@ pub enum GPIOPinFunction {
   AltFn5 = 2,
 }
 
-pub const GPIO_DELAY: u64 = 150;
+/// @var GPIO_DELAY
+/// @brief   Pull-up/-down sequencing delay in microseconds.
+/// @details The datasheets call for 150 cycles of set-up and hold around the
+///          GPPUDCLK writes; one microsecond comfortably covers that at any
+///          supported core clock.
+pub const GPIO_DELAY: u64 = 1;
 
 /// @fn set_pin_function(pin: GPIOPin, func: GPIOPinFunction)
 /// @brief Changes the function assignment for a GPIO pin.
@@ -1,4 +1,6 @@
 use super::base;
+use crate::arch;
+use crate::debug::profile;
 
 pub const MBOX_REQUEST: u32 = 0;
 
@@ -13,7 +15,9 @@ pub const _MBOX_CH_COUNT: u32 = 7;
 pub const MBOX_CH_PROP: u32 = 8;
 
 pub const _MBOX_TAG_SETPOWER: u32 = 0x28001;
-pub const _MBOX_TAG_SETCLKRATE: u32 = 0x38002;
+pub const MBOX_TAG_GETCLKRATE: u32 = 0x30002;
+pub const MBOX_TAG_GETMAXCLKRATE: u32 = 0x30004;
+pub const MBOX_TAG_SETCLKRATE: u32 = 0x38002;
 
 pub const MBOX_TAG_SETPHYWH: u32 = 0x48003;
 pub const MBOX_TAG_SETVIRTWH: u32 = 0x48004;
@@ -30,13 +34,17 @@ const MBOX_READ: usize = VIDEOCORE_MBOX + 0x0;
 const _MBOX_POLL: usize = VIDEOCORE_MBOX + 0x10;
 const _MBOX_SENDER: usize = VIDEOCORE_MBOX + 0x14;
 const MBOX_STATUS: usize = VIDEOCORE_MBOX + 0x18;
-const _MBOX_CONFIG: usize = VIDEOCORE_MBOX + 0x1C;
+const MBOX_CONFIG: usize = VIDEOCORE_MBOX + 0x1C;
 const MBOX_WRITE: usize = VIDEOCORE_MBOX + 0x20;
 
 const MBOX_RESPONSE: u32 = 0x80000000;
 const MBOX_FULL: u32 = 0x80000000;
 const MBOX_EMPTY: u32 = 0x40000000;
 
+/// @var MBOX_CONFIG_DATA_IRQ
+/// @brief MBOX_CONFIG bit enabling the data-available interrupt.
+const MBOX_CONFIG_DATA_IRQ: u32 = 0x1;
+
 pub const MAIL_SIZE: usize = 36;
 
 pub type Mail = [u32; MAIL_SIZE];
@@ -74,10 +82,20 @@ pub fn get_buffer_mut() -> &'static mut Mail {
 }
 
 /// @fn send(channel: u32, mail: &Mail) -> bool
-/// @brief   Send a request to the GPU mailbox.
+/// @brief   Send a request to the GPU mailbox and wait for its response.
+/// @details Masks interrupts for the whole round trip: once the mailbox
+///          interrupt is enabled, handle_interrupt would otherwise drain the
+///          response before the poll loop sees it. Responses for pending pool
+///          buffers read while masked are completed here exactly as the
+///          interrupt handler would complete them.
 /// @param[in] channel The mailbox channel.
 /// @returns True if the request succeeds.
 pub fn send(channel: u32) -> bool {
+  crate::trace!(crate::debug::trace::EVT_MAILBOX_SEND, channel);
+  let _scope = profile::Scope::enter(profile::STAT_MAILBOX_RTT);
+
+  let state = arch::cpu::save_and_disable_interrupts();
+
   // Wait for the GPU to empty the mailbox.
   while (base::peripheral_reg_get(MBOX_STATUS) & MBOX_FULL) != 0 {}
 
@@ -85,17 +103,32 @@ pub fn send(channel: u32) -> bool {
   let packed_addr = pack_address_and_channel(channel);
   base::peripheral_reg_put(packed_addr, MBOX_WRITE);
 
-  loop {
+  let status = loop {
     // Wait for the GPU to deposit data into the mailbox.
     while (base::peripheral_reg_get(MBOX_STATUS) & MBOX_EMPTY) != 0 {}
 
-    // Discard any responses not related to our request.
-    if base::peripheral_reg_get(MBOX_READ) == packed_addr {
-      unsafe {
-        return MAIL.mail[1] == MBOX_RESPONSE;
-      }
+    let packed = base::peripheral_reg_get(MBOX_READ);
+
+    if packed == packed_addr {
+      break unsafe { MAIL.mail[1] == MBOX_RESPONSE };
+    }
+
+    // Anything else is either a pending pool buffer's response, completed on
+    // the interrupt handler's behalf, or stale and discarded.
+    unsafe {
+      complete_response(packed);
     }
+  };
+
+  // Completing a pool response frees a mailbox slot but consumes the
+  // interrupt that would have fed the submit queue; feed it here.
+  unsafe {
+    pump_submit_queue();
   }
+
+  arch::cpu::restore_interrupts(state);
+
+  status
 }
 
 /// @fn pack_address_and_channel(channel: u32) -> u32
@@ -112,3 +145,272 @@ fn pack_address_and_channel(channel: u32) -> u32 {
     (raw_addr as u32) | (channel & 0xf)
   }
 }
+
+/// @struct MessageBuilder
+/// @brief   Typed builder for property messages.
+/// @details Replaces hand-counted word offsets: each tag call appends a tag
+///          header and its value words, and build terminates the message and
+///          fills in the total size. Every method is const, so a message
+///          with constant tags can be materialized as a const Mail at
+///          compile time; response values land at the same offsets the
+///          request values occupy.
+pub struct MessageBuilder {
+  mail: Mail,
+  next: usize,
+}
+
+impl MessageBuilder {
+  pub const fn new() -> Self {
+    let mut mail = [0; MAIL_SIZE];
+    mail[1] = MBOX_REQUEST;
+
+    MessageBuilder { mail, next: 2 }
+  }
+
+  /// @fn tag(self, tag: u32, values: &[u32]) -> MessageBuilder
+  /// @brief   Append a tag.
+  /// @details The value buffer is sized to the given words; tags whose
+  ///          response is larger than the request must pad with zeros.
+  /// @param[in] tag    The property tag.
+  /// @param[in] values The tag's value words.
+  /// @returns The builder.
+  pub const fn tag(mut self, tag: u32, values: &[u32]) -> Self {
+    let size = (values.len() * 4) as u32;
+
+    self.mail[self.next] = tag;
+    self.mail[self.next + 1] = size;
+    self.mail[self.next + 2] = size;
+
+    let mut i = 0;
+
+    while i < values.len() {
+      self.mail[self.next + 3 + i] = values[i];
+      i += 1;
+    }
+
+    self.next += 3 + values.len();
+
+    self
+  }
+
+  /// @fn build(self) -> Mail
+  /// @brief   Terminate and size the message.
+  /// @returns The finished message.
+  pub const fn build(mut self) -> Mail {
+    self.mail[self.next] = MBOX_TAG_LAST;
+    self.mail[0] = ((self.next + 1) * 4) as u32;
+
+    self.mail
+  }
+}
+
+/// @var POOL_SIZE
+/// @brief Number of property buffers in the asynchronous pool.
+pub const POOL_SIZE: usize = 4;
+
+/// @enum BufferState
+/// @brief The state of a pool buffer.
+#[derive(Copy, Clone, PartialEq)]
+enum BufferState {
+  /// Available for allocation.
+  Free,
+  /// Allocated and being filled by its owner.
+  Owned,
+  /// Submitted and waiting for the VideoCore's response.
+  Pending,
+  /// Response received; the owner may read it.
+  Complete,
+}
+
+/// @typedef Callback
+/// @brief A completion callback. Runs from the mailbox interrupt with the
+///        completed buffer's handle; it must not block.
+pub type Callback = fn(usize);
+
+/// @struct MailBuffer
+/// @brief A 16-byte-aligned property buffer; see _MailWrapper.
+#[repr(align(16))]
+struct MailBuffer {
+  mail: Mail,
+}
+
+const EMPTY_BUFFER: MailBuffer = MailBuffer {
+  mail: [0; MAIL_SIZE],
+};
+
+/// @var POOL
+/// @brief   The asynchronous property buffer pool and its bookkeeping.
+/// @details submit masks interrupts around the bookkeeping it shares with
+///          handle_interrupt; everything else only runs in task context.
+static mut POOL: [MailBuffer; POOL_SIZE] = [EMPTY_BUFFER; POOL_SIZE];
+
+static mut POOL_STATE: [BufferState; POOL_SIZE] = [BufferState::Free; POOL_SIZE];
+
+static mut CALLBACKS: [Option<Callback>; POOL_SIZE] = [None; POOL_SIZE];
+
+static mut CHANNELS: [u32; POOL_SIZE] = [0; POOL_SIZE];
+
+/// @var SUBMIT_QUEUE
+/// @brief FIFO of submitted handles waiting for mailbox space, drained by
+///        the interrupt handler as responses free slots.
+static mut SUBMIT_QUEUE: [usize; POOL_SIZE] = [0; POOL_SIZE];
+
+static mut SUBMIT_HEAD: usize = 0;
+
+static mut SUBMIT_COUNT: usize = 0;
+
+/// @fn enable_interrupt()
+/// @brief   Switch the mailbox to interrupt-driven completion.
+/// @details The caller is responsible for routing the mailbox interrupt to
+///          handle_interrupt at the interrupt controller.
+pub fn enable_interrupt() {
+  base::peripheral_reg_put(MBOX_CONFIG_DATA_IRQ, MBOX_CONFIG);
+}
+
+/// @fn alloc_buffer() -> Option<usize>
+/// @brief   Allocate a property buffer from the pool.
+/// @returns A handle for the buffer, or None if the pool is exhausted.
+pub fn alloc_buffer() -> Option<usize> {
+  unsafe {
+    for handle in 0..POOL_SIZE {
+      if POOL_STATE[handle] == BufferState::Free {
+        POOL_STATE[handle] = BufferState::Owned;
+        return Some(handle);
+      }
+    }
+  }
+
+  None
+}
+
+/// @fn buffer_mut(handle: usize) -> &'static mut Mail
+/// @brief   Get a pool buffer to fill out or read.
+/// @param[in] handle The buffer's handle.
+/// @returns The buffer.
+pub fn buffer_mut(handle: usize) -> &'static mut Mail {
+  assert!(handle < POOL_SIZE);
+  unsafe { &mut POOL[handle].mail }
+}
+
+/// @fn submit(handle: usize, channel: u32, callback: Option<Callback>)
+/// @brief   Submit a filled property buffer to the VideoCore.
+/// @details Returns immediately; the response arrives via the mailbox
+///          interrupt. The buffer stays owned by the mailbox until it
+///          completes.
+/// @param[in] handle   The buffer's handle.
+/// @param[in] channel  The mailbox channel.
+/// @param[in] callback An optional completion callback; without one the
+///                     owner polls with is_complete.
+pub fn submit(handle: usize, channel: u32, callback: Option<Callback>) {
+  assert!(handle < POOL_SIZE);
+
+  unsafe {
+    assert!(POOL_STATE[handle] == BufferState::Owned);
+
+    // The interrupt handler also writes the mailbox and pops the queue.
+    let state = arch::cpu::save_and_disable_interrupts();
+
+    CALLBACKS[handle] = callback;
+    CHANNELS[handle] = channel;
+    POOL_STATE[handle] = BufferState::Pending;
+
+    if SUBMIT_COUNT == 0 && (base::peripheral_reg_get(MBOX_STATUS) & MBOX_FULL) == 0 {
+      base::peripheral_reg_put(pack_pool_address(handle, channel), MBOX_WRITE);
+    } else {
+      SUBMIT_QUEUE[(SUBMIT_HEAD + SUBMIT_COUNT) % POOL_SIZE] = handle;
+      SUBMIT_COUNT += 1;
+    }
+
+    arch::cpu::restore_interrupts(state);
+  }
+}
+
+/// @fn is_complete(handle: usize) -> bool
+/// @brief   Poll a submitted buffer for completion.
+/// @param[in] handle The buffer's handle.
+/// @returns True once the VideoCore's response is in the buffer.
+pub fn is_complete(handle: usize) -> bool {
+  assert!(handle < POOL_SIZE);
+  unsafe { POOL_STATE[handle] == BufferState::Complete }
+}
+
+/// @fn free_buffer(handle: usize)
+/// @brief   Return a buffer to the pool.
+/// @details Only valid for buffers that are owned or complete; a pending
+///          buffer still belongs to the VideoCore.
+/// @param[in] handle The buffer's handle.
+pub fn free_buffer(handle: usize) {
+  assert!(handle < POOL_SIZE);
+
+  unsafe {
+    assert!(POOL_STATE[handle] != BufferState::Pending);
+    POOL_STATE[handle] = BufferState::Free;
+  }
+}
+
+/// @fn handle_interrupt()
+/// @brief   Service a mailbox interrupt.
+/// @details Drains the responses, completing their buffers and running any
+///          callbacks, then feeds queued submissions into the freed mailbox
+///          slots.
+pub fn handle_interrupt() {
+  unsafe {
+    while (base::peripheral_reg_get(MBOX_STATUS) & MBOX_EMPTY) == 0 {
+      complete_response(base::peripheral_reg_get(MBOX_READ));
+    }
+
+    pump_submit_queue();
+  }
+}
+
+/// @fn complete_response(packed: u32) -> bool
+/// @brief   Complete the pending pool buffer a response belongs to.
+/// @details Must run with interrupts masked or from the interrupt handler.
+/// @param[in] packed The packed address and channel read from the mailbox.
+/// @returns True if the response matched a pending buffer.
+unsafe fn complete_response(packed: u32) -> bool {
+  for handle in 0..POOL_SIZE {
+    if POOL_STATE[handle] != BufferState::Pending {
+      continue;
+    }
+
+    if pack_pool_address(handle, CHANNELS[handle]) != packed {
+      continue;
+    }
+
+    POOL_STATE[handle] = BufferState::Complete;
+
+    if let Some(callback) = CALLBACKS[handle] {
+      callback(handle);
+    }
+
+    return true;
+  }
+
+  false
+}
+
+/// @fn pump_submit_queue()
+/// @brief   Feed queued submissions into free mailbox slots.
+/// @details Must run with interrupts masked or from the interrupt handler.
+unsafe fn pump_submit_queue() {
+  while SUBMIT_COUNT > 0 && (base::peripheral_reg_get(MBOX_STATUS) & MBOX_FULL) == 0 {
+    let handle = SUBMIT_QUEUE[SUBMIT_HEAD];
+    SUBMIT_HEAD = (SUBMIT_HEAD + 1) % POOL_SIZE;
+    SUBMIT_COUNT -= 1;
+    base::peripheral_reg_put(pack_pool_address(handle, CHANNELS[handle]), MBOX_WRITE);
+  }
+}
+
+/// @fn pack_pool_address(handle: usize, channel: u32) -> u32
+/// @brief   Packs the channel number into a pool buffer address; see
+///          pack_address_and_channel.
+/// @param[in] handle  The buffer's handle.
+/// @param[in] channel The channel to pack into the address.
+/// @returns The 32-bit packed address and channel.
+fn pack_pool_address(handle: usize, channel: u32) -> u32 {
+  unsafe {
+    let raw_addr = (&POOL[handle].mail as *const u32 as usize) & 0xfffffff0usize;
+    (raw_addr as u32) | (channel & 0xf)
+  }
+}
@@ -1,12 +1,14 @@
 /// TODO: Move this out of kernel space as soon as video is available.
 use super::base;
 use super::gpio;
+use crate::drivers::clock;
 use core::str;
 
+const _AUX_IRQ: usize = 0x00215000;
 const AUX_ENABLES: usize = 0x00215004;
 const AUX_MU_IO_REG: usize = 0x00215040;
 const AUX_MU_IER_REG: usize = 0x00215044;
-const _AUX_MU_IIR_REG: usize = 0x00215048;
+const AUX_MU_IIR_REG: usize = 0x00215048;
 const AUX_MU_LCR_REG: usize = 0x0021504C;
 const AUX_MU_MCR_REG: usize = 0x00215050;
 const AUX_MU_LSR_REG: usize = 0x00215054;
@@ -16,19 +18,132 @@ const AUX_MU_CNTL_REG: usize = 0x00215060;
 const _AUX_MU_STAT_REG: usize = 0x00215064;
 const AUX_MU_BAUD_REG: usize = 0x00215068;
 
+// NOTE: The BCM2835 datasheet documents the IER bits the other way around.
+// The mini UART follows the 16550 layout: bit 0 enables the receive interrupt
+// and bit 1 enables the transmit interrupt.
+const AUX_MU_IER_RX_ENABLE: u32 = 0x1;
+const AUX_MU_IER_TX_ENABLE: u32 = 0x2;
+
+const AUX_MU_LSR_RX_READY: u32 = 0x01;
+const AUX_MU_LSR_TX_EMPTY: u32 = 0x20;
+const AUX_MU_LSR_TX_IDLE: u32 = 0x40;
+
+/// @var FIFO_DEPTH
+/// @brief   The mini UART transmit FIFO holds 8 bytes.
+/// @details Once the line status reports the transmitter idle, a full FIFO's
+///          worth of bytes can go out on a single status check.
+const FIFO_DEPTH: usize = 8;
+
+/// @var DEFAULT_BAUD_DIVISOR
+/// @brief   Baud divisor for 115200 at the firmware's 250 MHz core clock:
+///          250 MHz / (8 * (270 + 1)) ~ 115200.
+/// @details Only used until uart_set_baud re-derives the divisor from the
+///          actual core clock; the mini UART baud shifts with the VPU clock,
+///          so the clock governor must have the final say.
+const DEFAULT_BAUD_DIVISOR: u32 = 270;
+
+/// @var RING_SIZE
+/// @brief Size of the transmit and receive rings. Must be a power of 2.
+const RING_SIZE: usize = 1024;
+
+/// @struct ByteRing
+/// @brief   Single-producer, single-consumer byte ring.
+/// @details The transmit ring is filled by the kernel and drained by the
+///          interrupt handler; the receive ring is the reverse. The indices
+///          only increase and are masked on use, so the ring is empty when
+///          they are equal and full when they are RING_SIZE apart.
+/// @var buf  Ring storage.
+/// @var head Producer index.
+/// @var tail Consumer index.
+struct ByteRing {
+  buf: [u8; RING_SIZE],
+  head: usize,
+  tail: usize,
+}
+
+impl ByteRing {
+  const fn new() -> Self {
+    ByteRing {
+      buf: [0; RING_SIZE],
+      head: 0,
+      tail: 0,
+    }
+  }
+
+  /// @fn is_empty(&self) -> bool
+  /// @returns True if the ring has no pending bytes.
+  fn is_empty(&self) -> bool {
+    self.head == self.tail
+  }
+
+  /// @fn is_full(&self) -> bool
+  /// @returns True if the ring has no space left.
+  fn is_full(&self) -> bool {
+    self.head - self.tail == RING_SIZE
+  }
+
+  /// @fn push(&mut self, c: u8) -> bool
+  /// @brief   Add a byte to the ring.
+  /// @param[in] c The byte to add.
+  /// @returns False if the ring is full.
+  fn push(&mut self, c: u8) -> bool {
+    if self.is_full() {
+      return false;
+    }
+
+    self.buf[self.head & (RING_SIZE - 1)] = c;
+    self.head = self.head.wrapping_add(1);
+
+    true
+  }
+
+  /// @fn pop(&mut self) -> Option<u8>
+  /// @brief   Remove the oldest byte from the ring.
+  /// @returns The byte, or None if the ring is empty.
+  fn pop(&mut self) -> Option<u8> {
+    if self.is_empty() {
+      return None;
+    }
+
+    let c = self.buf[self.tail & (RING_SIZE - 1)];
+    self.tail = self.tail.wrapping_add(1);
+
+    Some(c)
+  }
+}
+
+/// @var TX_RING
+/// @brief Bytes waiting to go out over the UART. Producer is the kernel,
+///        consumer is the AUX interrupt handler.
+static mut TX_RING: ByteRing = ByteRing::new();
+
+/// @var RX_RING
+/// @brief Bytes received from the UART. Producer is the AUX interrupt
+///        handler, consumer is the kernel.
+static mut RX_RING: ByteRing = ByteRing::new();
+
+/// @var INTERRUPT_MODE
+/// @brief True once the driver has switched from polled to interrupt-driven
+///        operation. Only written by uart_set_interrupt_mode.
+static mut INTERRUPT_MODE: bool = false;
+
 /// @fn uart_init()
 /// @brief   Intialize UART1.
 /// @details Modifies GPFSEL1 to configure GPIO14 and GPIO15 to use their
 ///          Alternate Function 5 modes, UART1 TX and RX respectively. Disable
 ///          Pull-up/-down. Then enable and configure UART1.
 ///
-///          The system frequency is 250 MHz. The baud register value of 270
-///          translates to a baudrate of 250 MHz / (8 * (270 + 1)) ~ 115200.
+///          Starts at 115200 assuming the firmware's 250 MHz core clock;
+///          uart_set_baud re-derives the divisor once the clock governor has
+///          settled the real rate.
+///
+///          The UART starts out in polled mode. Interrupt-driven operation is
+///          enabled separately once the interrupt path is up.
 pub fn uart_init() {
   base::peripheral_reg_put(0, gpio::GPPUD);
-  base::peripheral_delay(gpio::GPIO_DELAY);
+  crate::timer::delay_usec(gpio::GPIO_DELAY);
   base::peripheral_reg_put(3 << 14, gpio::GPPUDCLK0);
-  base::peripheral_delay(gpio::GPIO_DELAY);
+  crate::timer::delay_usec(gpio::GPIO_DELAY);
   base::peripheral_reg_put(0, gpio::GPPUDCLK0);
 
   base::peripheral_reg_put(1, AUX_ENABLES); // Enable UART1
@@ -36,7 +151,7 @@ pub fn uart_init() {
   base::peripheral_reg_put(0, AUX_MU_IER_REG); // Disable interrupts
   base::peripheral_reg_put(3, AUX_MU_LCR_REG); // 8-bit data
   base::peripheral_reg_put(0, AUX_MU_MCR_REG); // RTS line is high
-  base::peripheral_reg_put(270, AUX_MU_BAUD_REG);
+  base::peripheral_reg_put(DEFAULT_BAUD_DIVISOR, AUX_MU_BAUD_REG);
 
   gpio::set_pin_function(gpio::GPIOPin::GPIO14, gpio::GPIOPinFunction::AltFn5);
   gpio::set_pin_function(gpio::GPIOPin::GPIO15, gpio::GPIOPinFunction::AltFn5);
@@ -44,13 +159,95 @@ pub fn uart_init() {
   base::peripheral_reg_put(3, AUX_MU_CNTL_REG);
 }
 
+/// @fn uart_set_baud(baud: u32)
+/// @brief   Derive and program the baud divisor from the actual core clock.
+/// @details The mini UART baud clock is the VPU core clock divided by 8, so
+///          the divisor must track whatever rate the clock governor settled
+///          on. Call after clock::init; does nothing if the rate is unknown.
+/// @param[in] baud The requested baud rate.
+pub fn uart_set_baud(baud: u32) {
+  let core = clock::current_rate(clock::CLOCK_CORE);
+
+  if core == 0 || baud == 0 {
+    return;
+  }
+
+  base::peripheral_reg_put(core / (8 * baud) - 1, AUX_MU_BAUD_REG);
+}
+
+/// @fn uart_set_interrupt_mode()
+/// @brief   Switch the driver to interrupt-driven operation.
+/// @details Enables the receive interrupt; the transmit interrupt is enabled
+///          on demand while the transmit ring has pending bytes. The caller is
+///          responsible for routing the AUX interrupt to uart_handle_interrupt
+///          at the interrupt controller.
+pub fn uart_set_interrupt_mode() {
+  unsafe {
+    INTERRUPT_MODE = true;
+  }
+
+  base::peripheral_reg_put(AUX_MU_IER_RX_ENABLE, AUX_MU_IER_REG);
+}
+
+/// @fn uart_handle_interrupt()
+/// @brief   Service an AUX interrupt.
+/// @details Drains the receive FIFO into the receive ring and refills the
+///          transmit FIFO from the transmit ring. The transmit interrupt is
+///          disabled once the transmit ring runs dry. Reading the IIR
+///          acknowledges the interrupt.
+pub fn uart_handle_interrupt() {
+  let _ = base::peripheral_reg_get(AUX_MU_IIR_REG);
+
+  unsafe {
+    while (base::peripheral_reg_get(AUX_MU_LSR_REG) & AUX_MU_LSR_RX_READY) != 0 {
+      let c = (base::peripheral_reg_get(AUX_MU_IO_REG) & 0xff) as u8;
+      // Drop received bytes on the floor if the kernel is not keeping up.
+      let _ = RX_RING.push(c);
+    }
+
+    // With the transmitter idle a full FIFO's worth of bytes can go out on
+    // the one status check; after that, top up while space remains.
+    if (base::peripheral_reg_get(AUX_MU_LSR_REG) & AUX_MU_LSR_TX_IDLE) != 0 {
+      for _ in 0..FIFO_DEPTH {
+        match TX_RING.pop() {
+          Some(c) => base::peripheral_reg_put(c as u32, AUX_MU_IO_REG),
+          None => break,
+        }
+      }
+    }
+
+    while (base::peripheral_reg_get(AUX_MU_LSR_REG) & AUX_MU_LSR_TX_EMPTY) != 0 {
+      match TX_RING.pop() {
+        Some(c) => base::peripheral_reg_put(c as u32, AUX_MU_IO_REG),
+        None => break,
+      }
+    }
+
+    let mut ier = AUX_MU_IER_RX_ENABLE;
+    if !TX_RING.is_empty() {
+      ier |= AUX_MU_IER_TX_ENABLE;
+    }
+    base::peripheral_reg_put(ier, AUX_MU_IER_REG);
+  }
+}
+
 /// @fn uart_recv() -> u8
-/// @brief   Receive a byte from UART1. Blocks until the a arrives.
+/// @brief   Receive a byte from UART1. Blocks until a byte arrives.
 /// @returns The received byte.
 pub fn _uart_recv() -> u8 {
+  unsafe {
+    if INTERRUPT_MODE {
+      loop {
+        if let Some(c) = RX_RING.pop() {
+          return c;
+        }
+      }
+    }
+  }
+
   loop {
     let c = base::peripheral_reg_get(AUX_MU_LSR_REG);
-    if c & 0x1 != 0 {
+    if c & AUX_MU_LSR_RX_READY != 0 {
       break;
     }
   }
@@ -58,26 +255,69 @@ pub fn _uart_recv() -> u8 {
   (base::peripheral_reg_get(AUX_MU_IO_REG) & 0xff) as u8
 }
 
-/// @fn uart_send(c: u8)
-/// @brief Send a byte to UART1. Blocks until the UART is ready.
-/// @param[in] c The byte to send.
-pub fn uart_send(c: u8) {
-  loop {
-    let c = base::peripheral_reg_get(AUX_MU_LSR_REG);
-    if c & 0x20 != 0 {
-      break;
+/// @fn uart_try_recv() -> Option<u8>
+/// @brief   Receive a byte from UART1 without blocking.
+/// @returns The received byte, or None if nothing is pending.
+pub fn uart_try_recv() -> Option<u8> {
+  unsafe {
+    if INTERRUPT_MODE {
+      return RX_RING.pop();
     }
   }
 
-  base::peripheral_reg_put(c as u32, AUX_MU_IO_REG);
+  if (base::peripheral_reg_get(AUX_MU_LSR_REG) & AUX_MU_LSR_RX_READY) == 0 {
+    return None;
+  }
+
+  Some((base::peripheral_reg_get(AUX_MU_IO_REG) & 0xff) as u8)
+}
+
+/// @fn uart_send(c: u8)
+/// @brief Send a byte to UART1. May block until the UART is ready.
+/// @param[in] c The byte to send.
+pub fn uart_send(c: u8) {
+  uart_send_bytes(&[c]);
 }
 
 /// @fn uart_send_bytes(s: &[u8])
-/// @brief Send an array of bytes to the mini UART.
+/// @brief   Send an array of bytes to the mini UART.
+/// @details In interrupt mode the bytes are queued on the transmit ring and
+///          drained by the AUX interrupt; if the ring fills up, this spins
+///          until the interrupt handler makes space. In polled mode this
+///          blocks until every byte is out.
 /// @param[in] s The byte array to send.
 pub fn uart_send_bytes(s: &[u8]) {
-  for c in s {
-    uart_send(*c);
+  crate::trace!(crate::debug::trace::EVT_UART_SEND, s.len());
+  unsafe {
+    if !INTERRUPT_MODE {
+      uart_send_bytes_blocking(s);
+      return;
+    }
+
+    for c in s {
+      while !TX_RING.push(*c) {}
+    }
+
+    base::peripheral_reg_put(AUX_MU_IER_RX_ENABLE | AUX_MU_IER_TX_ENABLE, AUX_MU_IER_REG);
+  }
+}
+
+/// @fn uart_send_bytes_blocking(s: &[u8])
+/// @brief   Send an array of bytes to the mini UART, bursting up to the FIFO
+///          depth per line status check.
+/// @details Waits for the transmitter to go idle, then writes a full FIFO's
+///          worth of bytes before polling again -- one status read per eight
+///          bytes instead of one per byte. This path does not depend on
+///          interrupts or the transmit ring and is safe to use from the panic
+///          handler.
+/// @param[in] s The byte array to send.
+pub fn uart_send_bytes_blocking(s: &[u8]) {
+  for chunk in s.chunks(FIFO_DEPTH) {
+    while (base::peripheral_reg_get(AUX_MU_LSR_REG) & AUX_MU_LSR_TX_IDLE) == 0 {}
+
+    for c in chunk {
+      base::peripheral_reg_put(*c as u32, AUX_MU_IO_REG);
+    }
   }
 }
 
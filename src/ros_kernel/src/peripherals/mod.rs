@@ -1,4 +1,7 @@
 pub mod base;
+pub mod dma;
 pub mod gpio;
 pub mod mailbox;
 pub mod mini_uart;
+pub mod pl011;
+pub mod uart;
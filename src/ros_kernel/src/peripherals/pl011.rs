@@ -0,0 +1,131 @@
+//! PL011 (UART0) console driver.
+//!
+//! The PL011 runs off the firmware-programmed UART clock rather than the VPU
+//! core clock, so its baud is stable across the clock governor's choices, and
+//! its 16-byte FIFOs halve the status polling of the mini UART. Polled only;
+//! at the multi-megabaud rates this driver exists for, bursts drain faster
+//! than interrupt handling costs.
+
+use super::base;
+use super::gpio;
+use crate::drivers::clock;
+
+const UART_DR: usize = 0x00201000;
+const UART_FR: usize = 0x00201018;
+const UART_IBRD: usize = 0x00201024;
+const UART_FBRD: usize = 0x00201028;
+const UART_LCRH: usize = 0x0020102C;
+const UART_CR: usize = 0x00201030;
+const UART_IMSC: usize = 0x00201038;
+const UART_ICR: usize = 0x00201044;
+
+const UART_FR_RXFE: u32 = 1 << 4;
+const UART_FR_TXFF: u32 = 1 << 5;
+const UART_FR_TXFE: u32 = 1 << 7;
+
+const UART_LCRH_FEN: u32 = 1 << 4;
+const UART_LCRH_WLEN8: u32 = 3 << 5;
+
+const UART_CR_UARTEN: u32 = 1 << 0;
+const UART_CR_TXE: u32 = 1 << 8;
+const UART_CR_RXE: u32 = 1 << 9;
+
+/// @var FIFO_DEPTH
+/// @brief The PL011 transmit FIFO holds 16 bytes.
+const FIFO_DEPTH: usize = 16;
+
+/// @var DEFAULT_UART_CLOCK
+/// @brief The firmware's default UART clock, used until the clock governor
+///        has cached the real rate.
+const DEFAULT_UART_CLOCK: u32 = 48_000_000;
+
+/// @var BAUD
+/// @brief   The console baud rate: log shipping runs at 1.5 Mbaud.
+/// @details 1.5 Mbaud needs a UART clock of at least 24 MHz; the firmware
+///          default is 48 MHz.
+const BAUD: u32 = 1_500_000;
+
+/// @fn uart_init()
+/// @brief   Initialize UART0 as the console.
+/// @details Takes GPIO14/15 for their Alternate Function 0 modes, UART0 TX
+///          and RX, which displaces the mini UART from the header pins. The
+///          integer and fractional divisors come from the UART clock:
+///          divider = clock / (16 * baud).
+pub fn uart_init() {
+  base::peripheral_reg_put(0, gpio::GPPUD);
+  crate::timer::delay_usec(gpio::GPIO_DELAY);
+  base::peripheral_reg_put(3 << 14, gpio::GPPUDCLK0);
+  crate::timer::delay_usec(gpio::GPIO_DELAY);
+  base::peripheral_reg_put(0, gpio::GPPUDCLK0);
+
+  let mut uart_clock = clock::current_rate(clock::CLOCK_UART);
+  if uart_clock == 0 {
+    uart_clock = DEFAULT_UART_CLOCK;
+  }
+
+  let ibrd = uart_clock / (16 * BAUD);
+  let fbrd = ((8 * uart_clock / BAUD) % 128 + 1) / 2;
+
+  base::peripheral_reg_put(0, UART_CR); // Disable while configuring
+  base::peripheral_reg_put(0x7ff, UART_ICR); // Clear pending interrupts
+  base::peripheral_reg_put(0, UART_IMSC); // Mask everything; polled only
+  base::peripheral_reg_put(ibrd, UART_IBRD);
+  base::peripheral_reg_put(fbrd, UART_FBRD);
+  base::peripheral_reg_put(UART_LCRH_WLEN8 | UART_LCRH_FEN, UART_LCRH);
+
+  gpio::set_pin_function(gpio::GPIOPin::GPIO14, gpio::GPIOPinFunction::AltFn0);
+  gpio::set_pin_function(gpio::GPIOPin::GPIO15, gpio::GPIOPinFunction::AltFn0);
+
+  base::peripheral_reg_put(UART_CR_UARTEN | UART_CR_TXE | UART_CR_RXE, UART_CR);
+}
+
+/// @fn uart_set_interrupt_mode()
+/// @brief No-op; the PL011 console is polled.
+pub fn uart_set_interrupt_mode() {}
+
+/// @fn uart_handle_interrupt()
+/// @brief No-op; the PL011 console is polled with everything masked.
+pub fn uart_handle_interrupt() {}
+
+/// @fn uart_try_recv() -> Option<u8>
+/// @brief   Receive a byte from UART0 without blocking.
+/// @returns The received byte, or None if nothing is pending.
+pub fn uart_try_recv() -> Option<u8> {
+  if (base::peripheral_reg_get(UART_FR) & UART_FR_RXFE) != 0 {
+    return None;
+  }
+
+  Some((base::peripheral_reg_get(UART_DR) & 0xff) as u8)
+}
+
+/// @fn uart_send(c: u8)
+/// @brief Send a byte to UART0. May block until the UART is ready.
+/// @param[in] c The byte to send.
+pub fn uart_send(c: u8) {
+  uart_send_bytes(&[c]);
+}
+
+/// @fn uart_send_bytes(s: &[u8])
+/// @brief   Send an array of bytes to UART0, bursting up to the FIFO depth
+///          per flag register check.
+/// @details Waits for the transmit FIFO to empty, then writes a full FIFO's
+///          worth of bytes before polling again. Safe from the panic handler.
+/// @param[in] s The byte array to send.
+pub fn uart_send_bytes(s: &[u8]) {
+  crate::trace!(crate::debug::trace::EVT_UART_SEND, s.len());
+
+  for chunk in s.chunks(FIFO_DEPTH) {
+    while (base::peripheral_reg_get(UART_FR) & UART_FR_TXFE) == 0 {}
+
+    for c in chunk {
+      base::peripheral_reg_put(*c as u32, UART_DR);
+    }
+  }
+}
+
+/// @fn uart_send_bytes_blocking(s: &[u8])
+/// @brief Alias of uart_send_bytes; the PL011 path is always polled.
+/// @param[in] s The byte array to send.
+pub fn uart_send_bytes_blocking(s: &[u8]) {
+  uart_send_bytes(s);
+}
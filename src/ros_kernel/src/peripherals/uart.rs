@@ -0,0 +1,18 @@
+//! Console UART selection.
+//!
+//! The mini UART is the default console. Boards that ship logs at high baud
+//! build with the pl011_console feature (-DPL011_CONSOLE=True from CMake) to
+//! route the console through UART0 instead; the two drivers export the same
+//! interface, so callers only name this module.
+
+#[cfg(not(feature = "pl011_console"))]
+pub use super::mini_uart::{
+  uart_handle_interrupt, uart_init, uart_send_bytes, uart_send_bytes_blocking,
+  uart_set_interrupt_mode, uart_try_recv,
+};
+
+#[cfg(feature = "pl011_console")]
+pub use super::pl011::{
+  uart_handle_interrupt, uart_init, uart_send_bytes, uart_send_bytes_blocking,
+  uart_set_interrupt_mode, uart_try_recv,
+};
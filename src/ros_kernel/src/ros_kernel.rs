@@ -1,7 +1,14 @@
+use crate::arch;
+use crate::debug::{log, profile, trace};
+use crate::drivers::clock;
 use crate::drivers::video::{console, framebuffer};
-use crate::peripherals::{base, mini_uart};
-use crate::support::atags;
+use crate::interrupts;
+use crate::mm::page_allocator;
+use crate::peripherals::{base, dma, mailbox, mini_uart, uart};
+use crate::smp;
 use crate::support::kernel_init::ROSKernelInit;
+use crate::support::{atags, dtb};
+use crate::task;
 use crate::{dbg_print, kprint};
 use core::panic::PanicInfo;
 
@@ -11,6 +18,9 @@ use core::panic::PanicInfo;
 /// @returns Does not return.
 #[panic_handler]
 fn panic(_info: &PanicInfo) -> ! {
+  // Push out anything still sitting in the log rings before halting. The
+  // drain task never runs again, so write straight to the wire.
+  log::drain_blocking();
   loop {}
 }
 
@@ -21,12 +31,15 @@ fn panic(_info: &PanicInfo) -> ! {
 /// @returns Does not return
 #[cfg(target_arch = "aarch64")]
 #[no_mangle]
-pub extern "C" fn kernel_stub(_blob: u32, peripheral_base: u32) -> ! {
+pub extern "C" fn kernel_stub(blob: u32, peripheral_base: u32) -> ! {
   let mut init = ROSKernelInit::new();
   init.peripheral_base = peripheral_base as usize;
 
-  // TODO: Attempt to parse a device tree if this is not an ATAG list.
-  // atags::read_atags(&mut init, blob);
+  // Pi 3 / Pi 4 firmware provides a DTB; fall back to ATAGs for bootloaders
+  // that still use them.
+  if !dtb::read_dtb(&mut init, blob as usize) {
+    atags::read_atags(&mut init, blob as usize);
+  }
 
   ros_kernel(init)
 }
@@ -39,32 +52,125 @@ pub extern "C" fn kernel_stub(_blob: u32, peripheral_base: u32) -> ! {
 /// @returns Does not return
 #[cfg(target_arch = "arm")]
 #[no_mangle]
-pub extern "C" fn kernel_stub(_machine_id: u32, _blob: u32, peripheral_base: u32) -> ! {
+pub extern "C" fn kernel_stub(_machine_id: u32, blob: u32, peripheral_base: u32) -> ! {
   let mut init = ROSKernelInit::new();
   init.peripheral_base = peripheral_base as usize;
 
-  // TODO: Attempt to parse a device tree if this is not an ATAG list.
-  // atags::read_atags(&mut init, blob);
+  // Pi 2 firmware provides a DTB; fall back to ATAGs for bootloaders that
+  // still use them.
+  if !dtb::read_dtb(&mut init, blob as usize) {
+    atags::read_atags(&mut init, blob as usize);
+  }
 
   ros_kernel(init)
 }
 
+/// @fn kernel_stub_secondary(core_id: u32) -> !
+/// @brief   AArch64 kernel stub for the secondary cores.
+/// @details Entered after the primary core releases the secondaries via
+///          smp::start_secondaries.
+/// @param[in] core_id The ID of the executing core.
+/// @returns Does not return
+#[cfg(target_arch = "aarch64")]
+#[no_mangle]
+pub extern "C" fn kernel_stub_secondary(core_id: u32) -> ! {
+  ros_kernel_secondary(core_id as usize)
+}
+
 /// @fn ros_kernel(init: *const ROSKernelInit) -> !
 /// @brief   Rust kernel entry point.
 /// @param[in] init Architecture-dependent initialization parameters.
 /// @returns Does not return.
 fn ros_kernel(init: ROSKernelInit) -> ! {
+  smp::mark_core_online(smp::core_id());
+
   init_peripherals(&init);
 
+  profile::init();
+  clock::init(init.clock_profile);
+  mini_uart::uart_set_baud(115200);
+
   dbg_print!("=== ROS ===\n");
   dbg_print!("Peripheral Base Address: {:#x}\n", init.peripheral_base);
 
+  page_allocator::init(&init.memory_regions);
+  dbg_print!(
+    "Page frames available: {}\n",
+    page_allocator::free_page_count()
+  );
+
+  init_interrupts(&init);
+
+  task::init();
+  log::start_drain_task();
+
   init_drivers();
 
   console::clear();
   kprint!("=== ROS ===\n");
   kprint!("Peripheral Base Address: {:#x}\n", init.peripheral_base);
 
+  smp::start_secondaries();
+
+  // The boot thread becomes the idle task once the tick starts preempting it.
+  task::start_preemption();
+
+  reclaim_init_pages();
+
+  #[cfg(feature = "bench")]
+  crate::bench::run();
+
+  // The idle task doubles as the stats console: 's' over the mini UART dumps
+  // the hot-path counters and 't' the event trace ring.
+  loop {
+    match uart::uart_try_recv() {
+      Some(b's') => profile::dump(),
+      Some(b't') => trace::dump(),
+      _ => {}
+    }
+  }
+}
+
+extern "C" {
+  static __init_start: u8;
+  static __init_end: u8;
+}
+
+/// @fn reclaim_init_pages()
+/// @brief   Return the init-only code pages to the frame allocator.
+/// @details The linker script groups .text.init on its own pages; nothing in
+///          the range runs after initialization completes, so the pages go
+///          back into the pool the same way init seeds regions.
+fn reclaim_init_pages() {
+  unsafe {
+    let start = &__init_start as *const u8 as usize;
+    let end = &__init_end as *const u8 as usize;
+    let mut page = start;
+
+    while page < end {
+      page_allocator::free_pages(page, 0);
+      page += page_allocator::PAGE_SIZE;
+    }
+
+    dbg_print!(
+      "Reclaimed {} KiB of init-only code.\n",
+      (end - start) / 1024
+    );
+  }
+}
+
+/// @fn ros_kernel_secondary(core_id: usize) -> !
+/// @brief   Rust kernel entry point for the secondary cores.
+/// @details The secondary cores have nothing to do until the kernel can hand
+///          them work, so they mark themselves online and idle.
+/// @param[in] core_id The ID of the executing core.
+/// @returns Does not return.
+#[allow(dead_code)]
+fn ros_kernel_secondary(core_id: usize) -> ! {
+  smp::mark_core_online(core_id);
+
+  dbg_print!("Core {} online.\n", core_id);
+
   loop {}
 }
 
@@ -73,7 +179,26 @@ fn ros_kernel(init: ROSKernelInit) -> ! {
 /// @param[in] init Architecture-dependent initialization parameters.
 fn init_peripherals(init: &ROSKernelInit) {
   base::set_peripheral_base_addr(init.peripheral_base);
-  mini_uart::uart_init();
+  uart::uart_init();
+}
+
+/// @fn init_interrupts(init: &ROSKernelInit)
+/// @brief   Initialize the interrupt controller and switch interrupt-driven
+///          peripherals over from polling.
+/// @param[in] init Architecture-dependent initialization parameters.
+fn init_interrupts(init: &ROSKernelInit) {
+  interrupts::init(init.peripheral_base);
+
+  interrupts::register_irq(interrupts::IRQ_AUX, uart::uart_handle_interrupt);
+  uart::uart_set_interrupt_mode();
+
+  interrupts::register_irq(interrupts::IRQ_MAILBOX, mailbox::handle_interrupt);
+  mailbox::enable_interrupt();
+
+  dma::init();
+  interrupts::register_irq(interrupts::IRQ_DMA, dma::handle_interrupt);
+
+  arch::cpu::enable_interrupts();
 }
 
 /// @fn init_drivers()
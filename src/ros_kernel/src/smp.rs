@@ -0,0 +1,62 @@
+use crate::arch::cpu;
+use core::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+
+/// @var MAX_CORES
+/// @brief Maximum number of cores supported by the kernel. All of the
+///        supported Raspberry Pi boards are quad-core.
+pub const MAX_CORES: usize = 4;
+
+const CORE_OFFLINE: AtomicBool = AtomicBool::new(false);
+
+/// @var CORE_ONLINE
+/// @brief Online flag for each core, set by the core itself when it enters
+///        Rustland.
+static CORE_ONLINE: [AtomicBool; MAX_CORES] = [CORE_OFFLINE; MAX_CORES];
+
+/// @var ONLINE_COUNT
+/// @brief Number of cores currently online.
+static ONLINE_COUNT: AtomicUsize = AtomicUsize::new(0);
+
+/// @fn core_id() -> usize
+/// @brief   Get the ID of the executing core.
+/// @returns The core ID.
+pub fn core_id() -> usize {
+  cpu::core_id()
+}
+
+/// @fn mark_core_online(core: usize)
+/// @brief Mark a core online. Each core calls this once for itself when it
+///        enters the kernel.
+/// @param[in] core The core ID.
+pub fn mark_core_online(core: usize) {
+  assert!(core < MAX_CORES);
+
+  if !CORE_ONLINE[core].swap(true, Ordering::AcqRel) {
+    ONLINE_COUNT.fetch_add(1, Ordering::AcqRel);
+  }
+}
+
+/// @fn core_is_online(core: usize) -> bool
+/// @brief   Check whether a core has entered the kernel.
+/// @param[in] core The core ID.
+/// @returns True if the core is online.
+pub fn _core_is_online(core: usize) -> bool {
+  assert!(core < MAX_CORES);
+  CORE_ONLINE[core].load(Ordering::Acquire)
+}
+
+/// @fn online_core_count() -> usize
+/// @brief   Get the number of cores currently online.
+/// @returns The online core count.
+pub fn online_core_count() -> usize {
+  ONLINE_COUNT.load(Ordering::Acquire)
+}
+
+/// @fn start_secondaries()
+/// @brief   Release the secondary cores into the kernel.
+/// @details Must only be called once by the primary core after peripheral
+///          initialization. The secondary cores enter the kernel through
+///          kernel_stub_secondary.
+pub fn start_secondaries() {
+  cpu::release_secondaries();
+}
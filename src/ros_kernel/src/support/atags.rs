@@ -68,6 +68,7 @@ struct ATAG {
 /// @param[in] init The kernel initialization struct to fill out.
 /// @param[in] blob Pointer to the ATAGs blob.
 /// @returns True if able to read ATAGs, false if the blob is not an ATAG list.
+#[link_section = ".text.init"]
 pub fn read_atags(init: &mut ROSKernelInit, blob: usize) -> bool {
   unsafe {
     let mut ptr = blob as *const u32;
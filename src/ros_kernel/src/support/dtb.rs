@@ -1 +1,477 @@
+use super::kernel_init::ROSKernelInit;
 
+const FDT_MAGIC: u32 = 0xd00dfeed;
+const FDT_BEGIN_NODE: u32 = 0x1;
+const _FDT_END_NODE: u32 = 0x2;
+const FDT_PROP: u32 = 0x3;
+const FDT_NOP: u32 = 0x4;
+const _FDT_END: u32 = 0x9;
+
+/// @var FDT_MIN_VERSION
+/// @brief Lowest supported FDT version. Version 17 added the struct block
+///        size to the header.
+const FDT_MIN_VERSION: u32 = 17;
+
+/// @var SOC_BUS_BASE
+/// @brief Legacy BCM283x bus address of the peripheral window. The SoC node's
+///        ranges property maps it to the CPU address for the board.
+const SOC_BUS_BASE: u64 = 0x7e000000;
+
+/// @var NODE_CACHE_SIZE
+/// @brief Number of node lookups memoized by find_node.
+const NODE_CACHE_SIZE: usize = 8;
+
+/// @struct NodeCacheEntry
+/// @brief Memoized node lookup.
+/// @var hash FNV-1a hash of the node path.
+/// @var addr Address of the node's FDT_BEGIN_NODE token.
+#[derive(Copy, Clone)]
+struct NodeCacheEntry {
+  hash: u32,
+  addr: usize,
+}
+
+/// @var NODE_CACHE
+/// @brief   Memoized node lookups so repeated driver queries do not re-walk
+///          the tree.
+/// @details Only valid while the bootloader blob is intact. The kernel is
+///          single-threaded, so directly accessing the cache is safe.
+static mut NODE_CACHE: [NodeCacheEntry; NODE_CACHE_SIZE] =
+  [NodeCacheEntry { hash: 0, addr: 0 }; NODE_CACHE_SIZE];
+
+static mut NODE_CACHE_COUNT: usize = 0;
+
+/// @struct DTBField
+/// @brief A field encountered while scanning a node's contents.
+/// @var Prop A property: name address in the strings block, data address,
+///           data length, and the address of the next field.
+/// @var Node A child node's FDT_BEGIN_NODE token address.
+/// @var End  The node's FDT_END_NODE (or the tree's FDT_END) token address.
+enum DTBField {
+  Prop {
+    name: usize,
+    data: usize,
+    len: usize,
+    next: usize,
+  },
+  Node(usize),
+  End(usize),
+}
+
+/// @struct DTB
+/// @brief   In-place flattened device tree parser.
+/// @details Walks the bootloader-provided blob directly with no copying and
+///          no allocation; it runs before any allocator exists.
+/// @var root            Address of the root node's FDT_BEGIN_NODE token.
+/// @var struct_end      Address one past the end of the struct block.
+/// @var strings         Address of the strings block.
+/// @var root_addr_cells Number of 32-bit cells in a root-level address.
+/// @var root_size_cells Number of 32-bit cells in a root-level size.
+pub struct DTB {
+  root: usize,
+  struct_end: usize,
+  strings: usize,
+  root_addr_cells: u32,
+  root_size_cells: u32,
+}
+
+impl DTB {
+  /// @fn new(blob: usize) -> Option<DTB>
+  /// @brief   Validate a bootloader blob as a flattened device tree.
+  /// @param[in] blob Address of the blob.
+  /// @returns The parser, or None if the blob is not a supported DTB.
+  pub fn new(blob: usize) -> Option<Self> {
+    if blob == 0 || (blob & 0x3) != 0 {
+      return None;
+    }
+
+    if be32(blob) != FDT_MAGIC || be32(blob + 20) < FDT_MIN_VERSION {
+      return None;
+    }
+
+    let struct_offs = be32(blob + 8) as usize;
+    let strings_offs = be32(blob + 12) as usize;
+    let struct_size = be32(blob + 36) as usize;
+
+    let mut dtb = DTB {
+      root: blob + struct_offs,
+      struct_end: blob + struct_offs + struct_size,
+      strings: blob + strings_offs,
+      root_addr_cells: 2,
+      root_size_cells: 1,
+    };
+
+    // Skip any NOPs ahead of the root node.
+    while be32(dtb.root) == FDT_NOP {
+      dtb.root += 4;
+    }
+
+    if be32(dtb.root) != FDT_BEGIN_NODE {
+      return None;
+    }
+
+    if let Some((data, _)) = dtb.find_prop(dtb.root, "#address-cells") {
+      dtb.root_addr_cells = be32(data);
+    }
+
+    if let Some((data, _)) = dtb.find_prop(dtb.root, "#size-cells") {
+      dtb.root_size_cells = be32(data);
+    }
+
+    Some(dtb)
+  }
+
+  /// @fn find_node(&self, path: &str) -> Option<usize>
+  /// @brief   Find a node by absolute path, e.g. "/soc/gpio".
+  /// @details Unit addresses may be omitted from path components; "/soc"
+  ///          matches "soc@7e000000". Lookups are memoized.
+  /// @param[in] path The node path.
+  /// @returns The node address, or None if the path does not exist.
+  pub fn find_node(&self, path: &str) -> Option<usize> {
+    let hash = fnv1a(path);
+
+    unsafe {
+      for entry in NODE_CACHE.iter().take(NODE_CACHE_COUNT) {
+        if entry.hash == hash {
+          return Some(entry.addr);
+        }
+      }
+    }
+
+    let mut node = self.root;
+
+    for comp in path.split('/') {
+      if comp.is_empty() {
+        continue;
+      }
+
+      node = self.find_child(node, comp)?;
+    }
+
+    unsafe {
+      if NODE_CACHE_COUNT < NODE_CACHE_SIZE {
+        NODE_CACHE[NODE_CACHE_COUNT] = NodeCacheEntry { hash, addr: node };
+        NODE_CACHE_COUNT += 1;
+      }
+    }
+
+    Some(node)
+  }
+
+  /// @fn find_prop(&self, node: usize, name: &str) -> Option<(usize, usize)>
+  /// @brief   Find a property of a node.
+  /// @param[in] node The node address.
+  /// @param[in] name The property name.
+  /// @returns The property data address and length, or None.
+  pub fn find_prop(&self, node: usize, name: &str) -> Option<(usize, usize)> {
+    let mut offs = self.first_field(node);
+
+    loop {
+      match self.next_field(offs) {
+        DTBField::Prop {
+          name: prop_name,
+          data,
+          len,
+          next,
+        } => {
+          if str_matches(prop_name, name, false) {
+            return Some((data, len));
+          }
+          offs = next;
+        }
+        // Properties precede child nodes, so the search is over.
+        _ => return None,
+      }
+    }
+  }
+
+  /// @fn find_child(&self, node: usize, name: &str) -> Option<usize>
+  /// @brief   Find a direct child of a node by name.
+  /// @param[in] node The parent node address.
+  /// @param[in] name The child name; the unit address may be omitted.
+  /// @returns The child node address, or None.
+  fn find_child(&self, node: usize, name: &str) -> Option<usize> {
+    let mut offs = self.first_field(node);
+
+    loop {
+      match self.next_field(offs) {
+        DTBField::Prop { next, .. } => offs = next,
+        DTBField::Node(child) => {
+          if str_matches(child + 4, name, true) {
+            return Some(child);
+          }
+          offs = self.skip_node(child);
+        }
+        DTBField::End(_) => return None,
+      }
+    }
+  }
+
+  /// @fn first_field(&self, node: usize) -> usize
+  /// @brief   Get the address of a node's first field.
+  /// @param[in] node The node address.
+  /// @returns The address of the first token after the node's name.
+  fn first_field(&self, node: usize) -> usize {
+    let mut offs = node + 4;
+
+    unsafe {
+      while *(offs as *const u8) != 0 {
+        offs += 1;
+      }
+    }
+
+    (offs + 4) & !0x3
+  }
+
+  /// @fn next_field(&self, offs: usize) -> DTBField
+  /// @brief   Decode the field at an address, skipping NOPs.
+  /// @param[in] offs The field address.
+  /// @returns The decoded field.
+  fn next_field(&self, offs: usize) -> DTBField {
+    let mut offs = offs;
+
+    loop {
+      if offs >= self.struct_end {
+        return DTBField::End(offs);
+      }
+
+      match be32(offs) {
+        FDT_NOP => offs += 4,
+        FDT_PROP => {
+          let len = be32(offs + 4) as usize;
+
+          return DTBField::Prop {
+            name: self.strings + be32(offs + 8) as usize,
+            data: offs + 12,
+            len,
+            next: offs + 12 + ((len + 3) & !0x3),
+          };
+        }
+        FDT_BEGIN_NODE => return DTBField::Node(offs),
+        _ => return DTBField::End(offs),
+      }
+    }
+  }
+
+  /// @fn skip_node(&self, node: usize) -> usize
+  /// @brief   Skip over a node and everything below it.
+  /// @param[in] node The node address.
+  /// @returns The address of the first token after the node's FDT_END_NODE.
+  fn skip_node(&self, node: usize) -> usize {
+    let mut offs = self.first_field(node);
+
+    loop {
+      match self.next_field(offs) {
+        DTBField::Prop { next, .. } => offs = next,
+        DTBField::Node(child) => offs = self.skip_node(child),
+        DTBField::End(end) => return end + 4,
+      }
+    }
+  }
+
+  /// @fn read_memory(&self, init: &mut ROSKernelInit)
+  /// @brief Add the regions of every root-level memory node to the kernel
+  ///        initialization struct.
+  /// @param[in] init The kernel initialization struct.
+  fn read_memory(&self, init: &mut ROSKernelInit) {
+    let mut offs = self.first_field(self.root);
+
+    loop {
+      match self.next_field(offs) {
+        DTBField::Prop { next, .. } => offs = next,
+        DTBField::Node(child) => {
+          if str_matches(child + 4, "memory", true) {
+            if let Some((data, len)) = self.find_prop(child, "reg") {
+              self.add_memory_regions(init, data, len);
+            }
+          }
+          offs = self.skip_node(child);
+        }
+        DTBField::End(_) => return,
+      }
+    }
+  }
+
+  /// @fn add_memory_regions(&self, init: &mut ROSKernelInit, data: usize, len: usize)
+  /// @brief Add the (base, size) entries of a reg property to the kernel
+  ///        initialization struct.
+  /// @param[in] init The kernel initialization struct.
+  /// @param[in] data The reg property data address.
+  /// @param[in] len  The reg property data length.
+  fn add_memory_regions(&self, init: &mut ROSKernelInit, data: usize, len: usize) {
+    let entry = ((self.root_addr_cells + self.root_size_cells) * 4) as usize;
+    let mut offs = data;
+
+    while offs + entry <= data + len {
+      let base = read_cells(offs, self.root_addr_cells);
+      let size = read_cells(
+        offs + (self.root_addr_cells * 4) as usize,
+        self.root_size_cells,
+      );
+
+      if size != 0 {
+        for rgn in init.memory_regions.iter_mut() {
+          if rgn.size == 0 {
+            rgn.base = base as usize;
+            rgn.size = size as usize;
+            break;
+          }
+        }
+      }
+
+      offs += entry;
+    }
+  }
+
+  /// @fn read_initrd(&self, init: &mut ROSKernelInit)
+  /// @brief Read the initrd location from the chosen node, if the bootloader
+  ///        provided one.
+  /// @param[in] init The kernel initialization struct.
+  fn read_initrd(&self, init: &mut ROSKernelInit) {
+    let chosen = match self.find_node("/chosen") {
+      Some(node) => node,
+      None => return,
+    };
+
+    let start = match self.find_prop(chosen, "linux,initrd-start") {
+      Some((data, len)) => read_cells(data, (len / 4) as u32),
+      None => return,
+    };
+
+    let end = match self.find_prop(chosen, "linux,initrd-end") {
+      Some((data, len)) => read_cells(data, (len / 4) as u32),
+      None => return,
+    };
+
+    if end > start {
+      init.initrd_base = start as usize;
+      init.initrd_size = (end - start) as usize;
+    }
+  }
+
+  /// @fn read_peripheral_base(&self, init: &mut ROSKernelInit)
+  /// @brief   Read the peripheral base address from the SoC node's ranges.
+  /// @details Leaves the initialization struct untouched if the mapping for
+  ///          the peripheral window cannot be found.
+  /// @param[in] init The kernel initialization struct.
+  fn read_peripheral_base(&self, init: &mut ROSKernelInit) {
+    let soc = match self.find_node("/soc") {
+      Some(node) => node,
+      None => return,
+    };
+
+    let child_addr_cells = match self.find_prop(soc, "#address-cells") {
+      Some((data, _)) => be32(data),
+      None => 2,
+    };
+
+    let child_size_cells = match self.find_prop(soc, "#size-cells") {
+      Some((data, _)) => be32(data),
+      None => 1,
+    };
+
+    let (data, len) = match self.find_prop(soc, "ranges") {
+      Some(prop) => prop,
+      None => return,
+    };
+
+    let entry = ((child_addr_cells + self.root_addr_cells + child_size_cells) * 4) as usize;
+    let mut offs = data;
+
+    while offs + entry <= data + len {
+      let child = read_cells(offs, child_addr_cells);
+      let parent = read_cells(offs + (child_addr_cells * 4) as usize, self.root_addr_cells);
+      let size = read_cells(
+        offs + ((child_addr_cells + self.root_addr_cells) * 4) as usize,
+        child_size_cells,
+      );
+
+      if child <= SOC_BUS_BASE && SOC_BUS_BASE < child + size {
+        init.peripheral_base = (parent + (SOC_BUS_BASE - child)) as usize;
+        return;
+      }
+
+      offs += entry;
+    }
+  }
+}
+
+/// @fn read_dtb(init: &mut ROSKernelInit, blob: usize) -> bool
+/// @brief   Read the device tree provided by the bootloader.
+/// @param[in] init The kernel initialization struct to fill out.
+/// @param[in] blob Pointer to the device tree blob.
+/// @returns True if able to read the device tree, false if the blob is not a
+///          supported DTB.
+pub fn read_dtb(init: &mut ROSKernelInit, blob: usize) -> bool {
+  let dtb = match DTB::new(blob) {
+    Some(dtb) => dtb,
+    None => return false,
+  };
+
+  dtb.read_memory(init);
+  dtb.read_initrd(init);
+  dtb.read_peripheral_base(init);
+
+  true
+}
+
+/// @fn be32(addr: usize) -> u32
+/// @brief   Read a big-endian 32-bit integer; all FDT integers are
+///          big-endian.
+/// @param[in] addr The address to read.
+/// @returns The integer in host byte order.
+fn be32(addr: usize) -> u32 {
+  u32::from_be(unsafe { *(addr as *const u32) })
+}
+
+/// @fn read_cells(addr: usize, cells: u32) -> u64
+/// @brief   Read a big-endian FDT value spanning one or more 32-bit cells.
+/// @param[in] addr  The address to read.
+/// @param[in] cells The number of cells.
+/// @returns The value; values wider than 64 bits keep their low 64.
+fn read_cells(addr: usize, cells: u32) -> u64 {
+  let mut value: u64 = 0;
+
+  for cell in 0..cells as usize {
+    value = (value << 32) | be32(addr + (cell * 4)) as u64;
+  }
+
+  value
+}
+
+/// @fn str_matches(addr: usize, name: &str, unit: bool) -> bool
+/// @brief   Compare a NUL-terminated string in the blob against a name.
+/// @param[in] addr The address of the string.
+/// @param[in] name The name to match.
+/// @param[in] unit True to treat a '@' after the match as a unit address and
+///                 accept it, e.g. "memory" matching "memory@0".
+/// @returns True if the strings match.
+fn str_matches(addr: usize, name: &str, unit: bool) -> bool {
+  let mut offs = addr;
+
+  for &b in name.as_bytes() {
+    if unsafe { *(offs as *const u8) } != b {
+      return false;
+    }
+
+    offs += 1;
+  }
+
+  let term = unsafe { *(offs as *const u8) };
+
+  term == 0 || (unit && term == b'@')
+}
+
+/// @fn fnv1a(s: &str) -> u32
+/// @brief   FNV-1a hash for the node cache.
+/// @param[in] s The string to hash.
+/// @returns The hash.
+fn fnv1a(s: &str) -> u32 {
+  let mut hash: u32 = 0x811c9dc5;
+
+  for &b in s.as_bytes() {
+    hash = (hash ^ b as u32).wrapping_mul(0x01000193);
+  }
+
+  hash
+}
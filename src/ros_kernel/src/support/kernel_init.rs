@@ -1,3 +1,5 @@
+use crate::drivers::clock;
+
 const MAX_MEM_REGIONS: usize = 16;
 
 /// @struct ROSMemoryRegion
@@ -20,9 +22,15 @@ impl ROSMemoryRegion {
 /// @brief Initialization parameters provided by the bootloader.
 /// @var peripheral_base The base address for peripherals.
 /// @var memory_regions  Memory regions available to the kernel.
+/// @var initrd_base     The base address of the initrd, or 0 if none.
+/// @var initrd_size     The size of the initrd in bytes, or 0 if none.
+/// @var clock_profile   The boot clock profile for the clock governor.
 pub struct ROSKernelInit {
   pub peripheral_base: usize,
   pub memory_regions: [ROSMemoryRegion; MAX_MEM_REGIONS],
+  pub initrd_base: usize,
+  pub initrd_size: usize,
+  pub clock_profile: clock::Profile,
 }
 
 impl ROSKernelInit {
@@ -30,6 +38,9 @@ impl ROSKernelInit {
     ROSKernelInit {
       peripheral_base: 0x0,
       memory_regions: [ROSMemoryRegion::new(); MAX_MEM_REGIONS],
+      initrd_base: 0x0,
+      initrd_size: 0x0,
+      clock_profile: clock::Profile::Balanced,
     }
   }
 }
@@ -0,0 +1,52 @@
+//! Bulk fill and copy primitives.
+//!
+//! On AArch64 these are backed by the NEON kernels in memory.S; the other
+//! architectures use the generic core paths. Exception frames only save the
+//! integer registers, so the NEON paths must only be called from task
+//! context.
+
+#[cfg(target_arch = "aarch64")]
+extern "C" {
+  fn mem_fill_words(dst: *mut u32, value: u32, count: usize);
+  fn mem_copy(dst: *mut u8, src: *const u8, size: usize);
+}
+
+/// @fn fill_words(dst: *mut u32, value: u32, count: usize)
+/// @brief   Fill a buffer with a 32-bit value.
+/// @details Cache-line-aligned zero fills use DC ZVA on AArch64, zeroing
+///          whole lines without writing data on the bus.
+/// @param[in] dst   The destination; must be word aligned.
+/// @param[in] value The fill value.
+/// @param[in] count The number of words to fill.
+pub fn fill_words(dst: *mut u32, value: u32, count: usize) {
+  #[cfg(target_arch = "aarch64")]
+  unsafe {
+    mem_fill_words(dst, value, count);
+  }
+
+  #[cfg(not(target_arch = "aarch64"))]
+  unsafe {
+    for i in 0..count {
+      *dst.add(i) = value;
+    }
+  }
+}
+
+/// @fn copy(dst: *mut u8, src: *const u8, size: usize)
+/// @brief   Copy a buffer.
+/// @details The copy runs forward; the regions must not overlap with the
+///          destination above the source.
+/// @param[in] dst  The destination.
+/// @param[in] src  The source.
+/// @param[in] size The size in bytes.
+pub fn copy(dst: *mut u8, src: *const u8, size: usize) {
+  #[cfg(target_arch = "aarch64")]
+  unsafe {
+    mem_copy(dst, src, size);
+  }
+
+  #[cfg(not(target_arch = "aarch64"))]
+  unsafe {
+    core::ptr::copy(src, dst, size);
+  }
+}
@@ -1,3 +1,6 @@
 pub mod atags;
+pub mod dtb;
 pub mod kernel_init;
+pub mod mem;
+pub mod per_core;
 pub mod print;
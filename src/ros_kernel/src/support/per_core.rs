@@ -0,0 +1,67 @@
+use crate::arch;
+use core::cell::UnsafeCell;
+
+/// @var MAX_CORES
+/// @brief Slots per PerCore value; must cover every core ID.
+pub const MAX_CORES: usize = 4;
+
+/// @struct Slot
+/// @brief   One core's slot, padded out to a cache line.
+/// @details The alignment keeps neighboring cores' slots off the same cache
+///          line, so a core hammering its own slot never invalidates another
+///          core's.
+#[repr(align(64))]
+pub struct Slot<T> {
+  value: UnsafeCell<T>,
+}
+
+impl<T> Slot<T> {
+  pub const fn new(value: T) -> Self {
+    Slot {
+      value: UnsafeCell::new(value),
+    }
+  }
+}
+
+/// @struct PerCore
+/// @brief   Per-core mutable state, indexed by the executing core's ID.
+/// @details Each core only ever touches its own slot, so no synchronization
+///          is needed; that property is what makes the shared reference to a
+///          slot's interior safe to hand out mutably. Build instances with
+///          the per_core! macro.
+pub struct PerCore<T> {
+  slots: [Slot<T>; MAX_CORES],
+}
+
+unsafe impl<T> Sync for PerCore<T> {}
+
+impl<T> PerCore<T> {
+  pub const fn new(slots: [Slot<T>; MAX_CORES]) -> Self {
+    PerCore { slots }
+  }
+
+  /// @fn get(&self) -> &mut T
+  /// @brief   Get the executing core's slot.
+  /// @details The core ID comes from the software thread ID register, a
+  ///          single-instruction read; boot caches MPIDR there.
+  /// @returns A mutable reference to the executing core's value.
+  #[allow(clippy::mut_from_ref)]
+  pub fn get(&self) -> &mut T {
+    unsafe { &mut *self.slots[arch::cpu::core_id()].value.get() }
+  }
+}
+
+/// @def per_core!
+/// @brief Build a PerCore value with every slot initialized to the given
+///        constant expression.
+#[macro_export]
+macro_rules! per_core {
+  ($value:expr) => {
+    $crate::support::per_core::PerCore::new([
+      $crate::support::per_core::Slot::new($value),
+      $crate::support::per_core::Slot::new($value),
+      $crate::support::per_core::Slot::new($value),
+      $crate::support::per_core::Slot::new($value),
+    ])
+  };
+}
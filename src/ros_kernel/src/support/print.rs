@@ -1,9 +1,12 @@
+use crate::per_core;
+use crate::support::per_core::PerCore;
 use core::fmt;
 
-/// @var WRITE_BUFFER
-/// @brief 2KiB static buffer for formatting strings. Since the kernel is
-///        single-threaded, directly accessing the buffer is safe.
-static mut WRITE_BUFFER: [u8; 2048] = [0; 2048];
+/// @var WRITE_BUFFERS
+/// @brief 2 KiB per-core buffers for formatting strings. Each core only
+///        formats into its own slot, so directly accessing it is safe.
+#[link_section = ".data.hot"]
+static WRITE_BUFFERS: PerCore<[u8; 2048]> = per_core!([0; 2048]);
 
 /// @struct WriteBuffer
 /// @brief  A thin wrapper around WRITE_BUFFER to track writes during string
@@ -50,5 +53,5 @@ impl<'buffer> fmt::Write for WriteBuffer<'buffer> {
 }
 
 pub fn new_string_format_buffer() -> WriteBuffer<'static> {
-  unsafe { WriteBuffer::new(&mut WRITE_BUFFER) }
+  WriteBuffer::new(WRITE_BUFFERS.get())
 }
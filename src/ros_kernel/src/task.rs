@@ -0,0 +1,322 @@
+use crate::arch;
+use crate::arch::task as arch_task;
+use crate::interrupts;
+use crate::mm::page_allocator;
+use crate::per_core;
+use crate::support::per_core::PerCore;
+use crate::timer;
+
+/// @var MAX_TASKS
+/// @brief Number of task slots; must match the width of the ready mask.
+pub const MAX_TASKS: usize = 32;
+
+/// @var STACK_ORDER
+/// @brief Page block order of a task's kernel stack; order 2 is 16 KiB.
+const STACK_ORDER: usize = 2;
+
+/// @var TICK_USEC
+/// @brief Preemption tick interval in microseconds.
+const TICK_USEC: u64 = 10000;
+
+/// @enum TaskState
+/// @brief The state of a task slot.
+#[derive(Copy, Clone, PartialEq)]
+enum TaskState {
+  Free,
+  Ready,
+  Zombie,
+}
+
+/// @struct Task
+/// @brief A kernel task.
+/// @var context The task's saved CPU context.
+/// @var fp      The task's saved FP/SIMD state; only written when another
+///              task takes the vector registers away.
+/// @var state   The task's state.
+/// @var stack   The base of the task's kernel stack, or 0 for the boot
+///              thread's firmware-provided stack.
+struct Task {
+  context: arch_task::CPUContext,
+  fp: arch_task::FpContext,
+  state: TaskState,
+  stack: usize,
+}
+
+impl Task {
+  const fn new() -> Self {
+    Task {
+      context: arch_task::CPUContext::new(),
+      fp: arch_task::FpContext::new(),
+      state: TaskState::Free,
+      stack: 0,
+    }
+  }
+}
+
+const FREE_TASK: Task = Task::new();
+
+/// @var TASKS
+/// @brief The task slots. The pool is shared, but a slot is only manipulated
+///        by the core whose run queue holds it, with interrupts masked, so
+///        directly accessing the slots is safe. Cross-core migration does not
+///        exist yet.
+static mut TASKS: [Task; MAX_TASKS] = [FREE_TASK; MAX_TASKS];
+
+/// @struct RunQueue
+/// @brief   One core's scheduler state.
+/// @details Everything the schedule and preemption paths touch per switch
+///          lives here, so the SMP bring-up gets a run queue per core instead
+///          of a pile of globals behind one lock.
+/// @var ready_mask   Bit mask of runnable tasks; it makes pick_next O(1).
+/// @var current      The executing task's slot index.
+/// @var need_resched Set by the tick handler on the IRQ stack; the IRQ
+///                   vector preempts on exit, once it is safe to switch
+///                   stacks.
+/// @var fp_owner     The task whose FP/SIMD state is live in this core's
+///                   vector registers, if any. FP/SIMD is trapped at boot;
+///                   the first task to touch the vector registers takes
+///                   ownership through the trap, and ownership only migrates
+///                   when a different task traps. Integer-only tasks never
+///                   appear here and never pay for the 512-byte state.
+struct RunQueue {
+  ready_mask: u32,
+  current: usize,
+  need_resched: bool,
+  fp_owner: Option<usize>,
+}
+
+impl RunQueue {
+  const fn new() -> Self {
+    RunQueue {
+      ready_mask: 0,
+      current: 0,
+      need_resched: false,
+      fp_owner: None,
+    }
+  }
+}
+
+/// @var RUN_QUEUES
+/// @brief Each core's scheduler state, indexed by the executing core.
+static RUN_QUEUES: PerCore<RunQueue> = per_core!(RunQueue::new());
+
+/// @fn init()
+/// @brief   Initialize the scheduler.
+/// @details Task 0 is the boot thread; its context is filled in the first
+///          time something switches away from it, and it becomes the idle
+///          task once initialization completes.
+pub fn init() {
+  let rq = RUN_QUEUES.get();
+
+  unsafe {
+    TASKS[0].state = TaskState::Ready;
+  }
+
+  rq.ready_mask = 0x1;
+  rq.current = 0;
+}
+
+/// @fn create_task(entry: fn(usize), arg: usize) -> Option<usize>
+/// @brief   Create a task.
+/// @param[in] entry The task entry point; it must not return.
+/// @param[in] arg   An argument passed to the entry point.
+/// @returns The task's slot index, or None if no slot or stack memory is
+///          available.
+pub fn create_task(entry: fn(usize), arg: usize) -> Option<usize> {
+  unsafe {
+    for id in 0..MAX_TASKS {
+      if TASKS[id].state != TaskState::Free {
+        continue;
+      }
+
+      let stack = page_allocator::alloc_pages(STACK_ORDER)?;
+      let stack_top = stack + (page_allocator::PAGE_SIZE << STACK_ORDER);
+
+      arch_task::init_context(&mut TASKS[id].context, entry as usize, arg, stack_top);
+      TASKS[id].fp = arch_task::FpContext::new();
+      TASKS[id].stack = stack;
+      TASKS[id].state = TaskState::Ready;
+      RUN_QUEUES.get().ready_mask |= 0x1 << id;
+
+      return Some(id);
+    }
+  }
+
+  None
+}
+
+/// @fn schedule()
+/// @brief   Switch to the next runnable task, if there is one.
+/// @details Round-robin: the next ready slot after the executing task runs
+///          next. Must be called on the executing task's own stack; IRQ
+///          handlers request a reschedule instead and the vector preempts on
+///          exit.
+///
+///          Interrupts are masked across the switch: a tick between updating
+///          the run queue and switching contexts would save the running
+///          context into the wrong slot. The saved interrupt state lives on
+///          the outgoing task's stack, so each task unmasks (or not) exactly
+///          as it had when it called in, no matter which path resumes it.
+pub fn schedule() {
+  let state = arch::cpu::save_and_disable_interrupts();
+  let rq = RUN_QUEUES.get();
+
+  unsafe {
+    reap_zombies();
+
+    let next = match pick_next(rq) {
+      Some(next) => next,
+      None => {
+        arch::cpu::restore_interrupts(state);
+        return;
+      }
+    };
+
+    let prev = rq.current;
+    rq.current = next;
+
+    if rq.fp_owner == Some(next) {
+      arch_task::fp_trap_disable();
+    } else {
+      arch_task::fp_trap_enable();
+    }
+
+    let prev_ctx = &mut *(&mut TASKS[prev].context as *mut arch_task::CPUContext);
+    let next_ctx = &*(&TASKS[next].context as *const arch_task::CPUContext);
+    arch_task::context_switch(prev_ctx, next_ctx);
+  }
+
+  arch::cpu::restore_interrupts(state);
+}
+
+/// @fn start_preemption()
+/// @brief Register the tick handler and start the preemption timer.
+pub fn start_preemption() {
+  interrupts::register_irq(interrupts::IRQ_TIMER, tick);
+  timer::start_tick(TICK_USEC);
+}
+
+/// @fn task_exit() -> !
+/// @brief   Retire the executing task.
+/// @details Also the landing point when a task entry point returns. The
+///          task's stack cannot be freed while it is executing on it, so the
+///          slot goes to Zombie and the scheduler reaps it later.
+/// @returns Does not return.
+#[no_mangle]
+pub extern "C" fn task_exit() -> ! {
+  let rq = RUN_QUEUES.get();
+
+  unsafe {
+    TASKS[rq.current].state = TaskState::Zombie;
+  }
+
+  rq.ready_mask &= !(0x1 << rq.current);
+
+  loop {
+    schedule();
+  }
+}
+
+/// @fn tick()
+/// @brief   Timer tick handler.
+/// @details Runs on the IRQ stack, so it cannot context switch itself;
+///          it programs the next tick and requests a reschedule on IRQ
+///          exit.
+fn tick() {
+  timer::rearm_tick();
+  RUN_QUEUES.get().need_resched = true;
+}
+
+/// @fn take_need_resched() -> bool
+/// @brief   Consume the pending reschedule request, if any.
+/// @returns True if a handler requested a reschedule.
+pub fn take_need_resched() -> bool {
+  let rq = RUN_QUEUES.get();
+  let resched = rq.need_resched;
+  rq.need_resched = false;
+  resched
+}
+
+/// @fn preempt_from_irq()
+/// @brief   Preempt the interrupted task.
+/// @details Called by the IRQ vector after it returns to the task's own
+///          stack; an ordinary call, so the slim IRQ frame plus
+///          switch_context's callee-saved frame cover the task's full state.
+#[no_mangle]
+pub extern "C" fn preempt_from_irq() {
+  schedule();
+}
+
+/// @fn fp_trap(esr: usize, far: usize) -> bool
+/// @brief   FP/SIMD access trap handler; performs the lazy state migration.
+/// @details Runs with interrupts masked on exception entry. Saves the
+///          previous owner's Q registers into its slot, loads the executing
+///          task's, and opens FP/SIMD access so the faulting instruction
+///          retries cleanly.
+/// @returns Always true; the faulting context resumes.
+pub fn fp_trap(_esr: usize, _far: usize) -> bool {
+  let rq = RUN_QUEUES.get();
+
+  unsafe {
+    arch_task::fp_trap_disable();
+
+    if let Some(owner) = rq.fp_owner {
+      if owner == rq.current {
+        return true;
+      }
+
+      arch_task::fp_save(&mut TASKS[owner].fp);
+    }
+
+    arch_task::fp_restore(&TASKS[rq.current].fp);
+  }
+
+  rq.fp_owner = Some(rq.current);
+
+  true
+}
+
+/// @fn pick_next(rq: &RunQueue) -> Option<usize>
+/// @brief   Pick the next task to run from a core's run queue.
+/// @details Rotating the ready mask puts the slots after the executing task
+///          first, so the round-robin choice is a single count of trailing
+///          zeros.
+/// @param[in] rq The executing core's run queue.
+/// @returns The next task's slot index, or None if no other task is
+///          runnable.
+fn pick_next(rq: &RunQueue) -> Option<usize> {
+  let mask = rq.ready_mask & !(0x1 << rq.current);
+
+  if mask == 0 {
+    return None;
+  }
+
+  let rotated = mask.rotate_right((rq.current as u32) + 1);
+
+  Some((rotated.trailing_zeros() as usize + rq.current + 1) % MAX_TASKS)
+}
+
+/// @fn reap_zombies()
+/// @brief Free the stacks of retired tasks that are no longer executing.
+fn reap_zombies() {
+  let rq = RUN_QUEUES.get();
+
+  unsafe {
+    for id in 0..MAX_TASKS {
+      if id == rq.current || TASKS[id].state != TaskState::Zombie {
+        continue;
+      }
+
+      if TASKS[id].stack != 0 {
+        page_allocator::free_pages(TASKS[id].stack, STACK_ORDER);
+        TASKS[id].stack = 0;
+      }
+
+      if rq.fp_owner == Some(id) {
+        rq.fp_owner = None;
+      }
+
+      TASKS[id].state = TaskState::Free;
+    }
+  }
+}
@@ -0,0 +1,82 @@
+use crate::arch::timer as arch_timer;
+
+const USEC_PER_SEC: u64 = 1000000;
+
+/// @var TICK_INTERVAL
+/// @brief Tick interrupt interval in counter ticks, or 0 when the tick is
+///        stopped. The kernel is single-threaded, so directly accessing the
+///        value is safe.
+static mut TICK_INTERVAL: u64 = 0;
+
+/// @fn uptime_usec() -> u64
+/// @brief   Get a monotonic timestamp.
+/// @details The generic timer counter starts near zero at power-on and runs
+///          at a fixed frequency independent of the core clock.
+/// @returns Microseconds since the counter started.
+pub fn uptime_usec() -> u64 {
+  ticks_to_usec(arch_timer::counter())
+}
+
+/// @fn delay_usec(usec: u64)
+/// @brief   Delay for at least the given number of microseconds.
+/// @details Polls the counter, so the duration does not depend on compiler
+///          flags or the core clock the way a counted busy-loop does.
+/// @param[in] usec The delay in microseconds.
+pub fn delay_usec(usec: u64) {
+  let end = arch_timer::counter() + usec_to_ticks(usec);
+
+  while arch_timer::counter() < end {}
+}
+
+/// @fn start_tick(usec: u64)
+/// @brief   Start the periodic tick interrupt.
+/// @details The timer raises its interrupt when the programmed interval
+///          elapses; the handler must call rearm_tick for the next one.
+/// @param[in] usec The tick interval in microseconds.
+pub fn start_tick(usec: u64) {
+  unsafe {
+    TICK_INTERVAL = usec_to_ticks(usec);
+    arch_timer::set_timer(TICK_INTERVAL);
+  }
+}
+
+/// @fn rearm_tick()
+/// @brief   Program the next tick.
+/// @details Called from the timer interrupt handler; re-arming also clears
+///          the timer's interrupt condition.
+pub fn rearm_tick() {
+  unsafe {
+    if TICK_INTERVAL != 0 {
+      arch_timer::set_timer(TICK_INTERVAL);
+    }
+  }
+}
+
+/// @fn _stop_tick()
+/// @brief Stop the periodic tick interrupt.
+pub fn _stop_tick() {
+  unsafe {
+    TICK_INTERVAL = 0;
+    arch_timer::stop_timer();
+  }
+}
+
+/// @fn usec_to_ticks(usec: u64) -> u64
+/// @brief   Convert microseconds to counter ticks, rounding up.
+/// @param[in] usec The duration in microseconds.
+/// @returns The duration in counter ticks.
+fn usec_to_ticks(usec: u64) -> u64 {
+  let freq = arch_timer::counter_freq() as u128;
+
+  (((usec as u128 * freq) + (USEC_PER_SEC - 1) as u128) / USEC_PER_SEC as u128) as u64
+}
+
+/// @fn ticks_to_usec(ticks: u64) -> u64
+/// @brief   Convert counter ticks to microseconds.
+/// @details The intermediate math is 128-bit so the conversion does not
+///          overflow for any counter value.
+/// @param[in] ticks The duration in counter ticks.
+/// @returns The duration in microseconds.
+fn ticks_to_usec(ticks: u64) -> u64 {
+  ((ticks as u128 * USEC_PER_SEC as u128) / arch_timer::counter_freq() as u128) as u64
+}
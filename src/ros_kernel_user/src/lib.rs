@@ -1 +1,25 @@
 #![no_std]
+
+//! Constants shared between the kernel's syscall dispatcher and the user
+//! library's wrappers.
+
+/// @var SYS_WRITE
+/// @brief Write bytes to the kernel log: arg0 = pointer, arg1 = length;
+///        returns the length written.
+pub const SYS_WRITE: usize = 0;
+
+/// @var SYS_YIELD
+/// @brief Give up the CPU to the next runnable task; returns 0.
+pub const SYS_YIELD: usize = 1;
+
+/// @var SYS_EXIT
+/// @brief Retire the calling task; does not return.
+pub const SYS_EXIT: usize = 2;
+
+/// @var SYS_COUNT
+/// @brief Number of syscalls; numbers at or above this fail with SYS_ENOSYS.
+pub const SYS_COUNT: usize = 3;
+
+/// @var SYS_ENOSYS
+/// @brief Returned for out-of-range syscall numbers.
+pub const SYS_ENOSYS: usize = usize::MAX;
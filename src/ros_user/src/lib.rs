@@ -1,3 +1,4 @@
 #![no_std]
 
 mod ros_user;
+pub mod syscall;
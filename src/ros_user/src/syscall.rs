@@ -0,0 +1,82 @@
+//! Typed syscall wrappers.
+//!
+//! Each wrapper issues an SVC with the syscall number in x8 (r7 on ARMv7)
+//! and up to three arguments in the first argument registers. The kernel's
+//! fast path treats the caller-saved registers as clobbered, which the
+//! clobber_abi annotation mirrors, so it never stacks them.
+
+#[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
+use core::arch::asm;
+use ros_kernel_user::{SYS_EXIT, SYS_WRITE, SYS_YIELD};
+
+/// @fn write(s: &str) -> usize
+/// @brief   Write a string to the kernel log.
+/// @param[in] s The string to write.
+/// @returns The number of bytes written.
+pub fn write(s: &str) -> usize {
+  syscall3(SYS_WRITE, s.as_ptr() as usize, s.len(), 0)
+}
+
+/// @fn yield_now()
+/// @brief Give up the CPU to the next runnable task.
+pub fn yield_now() {
+  syscall3(SYS_YIELD, 0, 0, 0);
+}
+
+/// @fn exit() -> !
+/// @brief   Retire the calling task.
+/// @returns Does not return.
+pub fn exit() -> ! {
+  syscall3(SYS_EXIT, 0, 0, 0);
+  unreachable!();
+}
+
+/// @fn syscall3(num: usize, arg0: usize, arg1: usize, arg2: usize) -> usize
+/// @brief   Issue a three-argument syscall.
+/// @param[in] num  The syscall number.
+/// @param[in] arg0 The first argument.
+/// @param[in] arg1 The second argument.
+/// @param[in] arg2 The third argument.
+/// @returns The syscall's result.
+#[cfg(target_arch = "aarch64")]
+fn syscall3(num: usize, arg0: usize, arg1: usize, arg2: usize) -> usize {
+  let result: usize;
+
+  unsafe {
+    asm!(
+      "svc #0",
+      in("x8") num,
+      inlateout("x0") arg0 => result,
+      in("x1") arg1,
+      in("x2") arg2,
+      clobber_abi("C"),
+    );
+  }
+
+  result
+}
+
+#[cfg(target_arch = "arm")]
+fn syscall3(num: usize, arg0: usize, arg1: usize, arg2: usize) -> usize {
+  let result: usize;
+
+  unsafe {
+    asm!(
+      "svc #0",
+      in("r7") num,
+      inlateout("r0") arg0 => result,
+      in("r1") arg1,
+      in("r2") arg2,
+      clobber_abi("C"),
+    );
+  }
+
+  result
+}
+
+/// @fn syscall3(num: usize, arg0: usize, arg1: usize, arg2: usize) -> usize
+/// @brief Host stub; keeps cargo check usable on development machines.
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+fn syscall3(_num: usize, _arg0: usize, _arg1: usize, _arg2: usize) -> usize {
+  0
+}